@@ -1,223 +1,181 @@
 #include "background.h"
+#include "core/render/asset_registry.h"
 #include "core/render/renderer.h"
+#include "core/render/mesh.h"
 #include <glm/glm.hpp>
+#include <iostream>
+#include <memory>
 #include <vector>
 
 namespace background {
 
 namespace {
-GLuint floorVAO = 0;
-GLuint floorVBO = 0;
-GLuint texOcean = 0;
-GLuint wallVAO = 0;
-GLuint wallVBO = 0;
-GLuint texSky = 0;
-GLuint wallFrontVAO = 0;
-GLuint wallFrontVBO = 0;
-GLuint wallRightVAO = 0;
-GLuint wallRightVBO = 0;
-GLuint wallBackVAO = 0;
-GLuint wallBackVBO = 0;
-GLuint texOceanNormal = 0;
+// All static background geometry lives in one vertex buffer; each piece is a sub-range.
+struct VBackground { glm::vec3 p; glm::vec2 uv; glm::vec3 n; glm::vec3 t; };
+struct Range { GLint first = 0; GLsizei count = 0; };
+GLuint backgroundVAO = 0;
+GLuint backgroundVBO = 0;
+Range floorRange;
+Range wallRange;   // the four sky walls, drawn as one range
+Range domeRange;   // upper half of skydome.obj, empty if the model failed to load
+bool skyDome = false;
+// Both day and night variants are streamed in up front, so toggling never waits on a load.
+TextureHandle oceanTex[2];   // [0] night, [1] day
+TextureHandle skyTex[2];
+TextureHandle oceanNormalTex;
+bool shownDayMode = true;    // variant currently drawn; lags dayModeFlag until the other one is resident
 float cachedMaxCoord = 0.0f;
 bool dayModeFlag = true;
 float bgScale = 4.0f;
+
+Range append(std::vector<VBackground>& data, const std::vector<VBackground>& part) {
+    Range range{static_cast<GLint>(data.size()), static_cast<GLsizei>(part.size())};
+    data.insert(data.end(), part.begin(), part.end());
+    return range;
+}
+
+// Quad (two triangles) from bottom-left, bottom-right, top-right, top-left; uv spans 4 x 1.
+void append_wall_quad(std::vector<VBackground>& out, glm::vec3 bl, glm::vec3 br, glm::vec3 tr, glm::vec3 tl) {
+    glm::vec3 t = glm::normalize(br - bl);
+    glm::vec3 n = glm::normalize(glm::cross(t, tl - bl));
+    out.insert(out.end(), {
+        {bl, {0,0}, n, t}, {br, {4,0}, n, t}, {tr, {4,1}, n, t},
+        {bl, {0,0}, n, t}, {tr, {4,1}, n, t}, {tl, {0,1}, n, t},
+    });
+}
+
+// skydome.obj is a unit sphere; its upper half is stretched over the same box as the walls
+// (radius half, from zLow to zHigh). v follows the height so the sky texture lines up with the walls.
+std::vector<VBackground> build_dome(float half, float zLow, float zHigh) {
+    std::vector<VBackground> out;
+    MeshHandle handle = gAssets.mesh_handle("assets/models/skydome.obj");
+    {
+        std::shared_ptr<Mesh> mesh = gAssets.mesh(handle);
+        if (!mesh || !mesh->has_texcoords()) {
+            std::cerr << "[Background] skydome.obj unavailable, sky dome disabled\n";
+            return out;
+        }
+        TriangleSoup soup = mesh->triangles();
+        const auto& pos = soup.positions;
+        const auto& uv = soup.texcoords;
+        size_t vertexCount = pos.size() / 3;
+        for (size_t tri = 0; tri + 3 <= vertexCount; tri += 3) {
+            if (pos[tri*3 + 2] < 0.0f && pos[tri*3 + 5] < 0.0f && pos[tri*3 + 8] < 0.0f)
+                continue;   // below the horizon, hidden by the floor
+            for (size_t v = tri; v < tri + 3; ++v) {
+                glm::vec3 unit(pos[v*3], pos[v*3 + 1], pos[v*3 + 2]);
+                glm::vec3 p(unit.x * half, unit.y * half, zLow + unit.z * (zHigh - zLow));
+                glm::vec3 n = -glm::normalize(unit);   // faces the inside
+                out.push_back({p, {uv[v*2] * 12.0f, unit.z}, n, glm::vec3(-unit.y, unit.x, 0.0f)});
+            }
+        }
+    }
+    gAssets.evict(handle);   // copied into the background buffer, the mesh itself is not needed
+    return out;
+}
 }
 
 void set_day_mode(bool dayMode) {
     dayModeFlag = dayMode;
-    // reload texture on next draw
-    texOcean = 0;
-    texSky = 0;
-    texOceanNormal = 0;
 }
 
 bool is_day_mode() { return dayModeFlag; }
 void set_scale(float scale) { bgScale = scale; }
 float get_scale() { return bgScale; }
 
+void set_sky_dome(bool enabled) { skyDome = enabled; }
+bool is_sky_dome() { return skyDome && domeRange.count > 0; }
+
 void shutdown() {
-    if (floorVBO) glDeleteBuffers(1, &floorVBO);
-    if (floorVAO) glDeleteVertexArrays(1, &floorVAO);
-    if (wallVBO) glDeleteBuffers(1, &wallVBO);
-    if (wallVAO) glDeleteVertexArrays(1, &wallVAO);
-    if (wallFrontVBO) glDeleteBuffers(1, &wallFrontVBO);
-    if (wallFrontVAO) glDeleteVertexArrays(1, &wallFrontVAO);
-    if (wallRightVBO) glDeleteBuffers(1, &wallRightVBO);
-    if (wallRightVAO) glDeleteVertexArrays(1, &wallRightVAO);
-    if (wallBackVBO) glDeleteBuffers(1, &wallBackVBO);
-    if (wallBackVAO) glDeleteVertexArrays(1, &wallBackVAO);
-    floorVBO = floorVAO = 0;
-    wallVBO = wallVAO = 0;
-    wallFrontVBO = wallFrontVAO = 0;
-    wallRightVBO = wallRightVAO = 0;
-    wallBackVBO = wallBackVAO = 0;
-    texOcean = 0;
-    texSky = 0;
-    texOceanNormal = 0;
+    if (backgroundVBO) glDeleteBuffers(1, &backgroundVBO);
+    if (backgroundVAO) glDeleteVertexArrays(1, &backgroundVAO);
+    backgroundVBO = backgroundVAO = 0;
+    floorRange = wallRange = domeRange = Range{};
     cachedMaxCoord = 0.0f;
 }
 
 void init(float maxCoord, bool dayMode) {
-    if (cachedMaxCoord == maxCoord && floorVAO != 0)
+    if (cachedMaxCoord == maxCoord && backgroundVAO != 0)
         return;
     shutdown();
     cachedMaxCoord = maxCoord;
     dayModeFlag = dayMode;
+    shownDayMode = dayMode;
+
+    oceanTex[0] = gAssets.texture_handle("assets/textures/diffuse_ocean_night.png");
+    oceanTex[1] = gAssets.texture_handle("assets/textures/diffuse_ocean_day.png");
+    skyTex[0] = gAssets.texture_handle("assets/textures/diffuse_sky_night.png");
+    skyTex[1] = gAssets.texture_handle("assets/textures/diffuse_sky_day.png");
+    oceanNormalTex = gAssets.texture_handle("assets/textures/normal_ocean.png");
+    for (TextureHandle handle : {oceanTex[dayMode], skyTex[dayMode], oceanNormalTex, oceanTex[!dayMode], skyTex[!dayMode]}) {
+        gAssets.pin(handle);
+        gAssets.prefetch(handle);
+    }
 
     float half = maxCoord * bgScale; // larger than gameplay area
     float z = -maxCoord * 0.5f;   // slightly below to avoid z-fighting
+    float zLow  = -0.5f * maxCoord;
+    float zHigh =  0.5f * maxCoord;  // sky height: MAX_COORD
 
-    struct VFloor { glm::vec3 p; glm::vec2 uv; glm::vec3 n; glm::vec3 t; };
+    std::vector<VBackground> data;
     glm::vec3 floorNormal(0.0f, 0.0f, 1.0f);
     glm::vec3 floorTangent(1.0f, 0.0f, 0.0f);
-    std::vector<VFloor> data = {
+    floorRange = append(data, {
         {{-half, -half, z}, {0,0}, floorNormal, floorTangent}, {{ half, -half, z}, {4,0}, floorNormal, floorTangent}, {{ half,  half, z}, {4,4}, floorNormal, floorTangent},
         {{-half, -half, z}, {0,0}, floorNormal, floorTangent}, {{ half,  half, z}, {4,4}, floorNormal, floorTangent}, {{-half,  half, z}, {0,4}, floorNormal, floorTangent},
-    };
-
-    glGenVertexArrays(1, &floorVAO);
-    glGenBuffers(1, &floorVBO);
-    glBindVertexArray(floorVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, floorVBO);
-    glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(VFloor), data.data(), GL_STATIC_DRAW);
+    });
+
+    // Left (+X normal), right (-X), front (-Y) and back (+Y) walls around the floor
+    std::vector<VBackground> walls;
+    append_wall_quad(walls, {-half, -half, zLow}, {-half,  half, zLow}, {-half,  half, zHigh}, {-half, -half, zHigh});
+    append_wall_quad(walls, { half,  half, zLow}, { half, -half, zLow}, { half, -half, zHigh}, { half,  half, zHigh});
+    append_wall_quad(walls, {-half,  half, zLow}, { half,  half, zLow}, { half,  half, zHigh}, {-half,  half, zHigh});
+    append_wall_quad(walls, { half, -half, zLow}, {-half, -half, zLow}, {-half, -half, zHigh}, { half, -half, zHigh});
+    wallRange = append(data, walls);
+
+    domeRange = append(data, build_dome(half, zLow, zHigh));
+
+    glGenVertexArrays(1, &backgroundVAO);
+    glGenBuffers(1, &backgroundVBO);
+    glBindVertexArray(backgroundVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, backgroundVBO);
+    glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(VBackground), data.data(), GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VFloor), (void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VBackground), (void*)0);
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VFloor), (void*)offsetof(VFloor, n));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VBackground), (void*)offsetof(VBackground, n));
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VFloor), (void*)offsetof(VFloor, uv));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VBackground), (void*)offsetof(VBackground, uv));
     glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(VFloor), (void*)offsetof(VFloor, t));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(VBackground), (void*)offsetof(VBackground, t));
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    struct V { glm::vec3 p; glm::vec2 uv; };
-
-    // Single side wall: normal +X, center at (-maxCoord*2, 0, 0)
-    {
-        float yHalf = maxCoord * bgScale;             // width along Y: bgScale*MAX_COORD*2
-        float zLow  = -0.5f * maxCoord;
-        float zHigh =  0.5f * maxCoord;              // height: MAX_COORD
-        float xCenter = -maxCoord * bgScale;
-        std::vector<V> data = {
-            {{xCenter, -yHalf, zLow }, {0,0}}, {{xCenter,  yHalf, zLow }, {4,0}}, {{xCenter,  yHalf, zHigh}, {4,1}},
-            {{xCenter, -yHalf, zLow }, {0,0}}, {{xCenter,  yHalf, zHigh}, {4,1}}, {{xCenter, -yHalf, zHigh}, {0,1}},
-        };
-        glGenVertexArrays(1, &wallVAO);
-        glGenBuffers(1, &wallVBO);
-        glBindVertexArray(wallVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, wallVBO);
-        glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(V), data.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void*)0);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(V), (void*)offsetof(V, uv));
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
-
-    // Right wall: normal -X, center at (+maxCoord*2, 0, 0)
-    {
-        float yHalf = maxCoord * bgScale;
-        float zLow  = -0.5f * maxCoord;
-        float zHigh =  0.5f * maxCoord;
-        float xCenter =  maxCoord * bgScale;
-        std::vector<V> data = {
-            {{xCenter,  yHalf, zLow }, {0,0}}, {{xCenter, -yHalf, zLow }, {4,0}}, {{xCenter, -yHalf, zHigh}, {4,1}},
-            {{xCenter,  yHalf, zLow }, {0,0}}, {{xCenter, -yHalf, zHigh}, {4,1}}, {{xCenter,  yHalf, zHigh}, {0,1}},
-        };
-        glGenVertexArrays(1, &wallRightVAO);
-        glGenBuffers(1, &wallRightVBO);
-        glBindVertexArray(wallRightVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, wallRightVBO);
-        glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(V), data.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void*)0);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(V), (void*)offsetof(V, uv));
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
-
-    // Front wall: normal -Y, center at (0,  maxCoord*2, 0)
-    {
-        float xHalf = maxCoord * bgScale;               // width: scaled
-        float zLow  = -0.5f * maxCoord;
-        float zHigh =  0.5f * maxCoord;              // height: MAX_COORD
-        float yCenter = maxCoord * bgScale;
-        std::vector<V> data = {
-            {{-xHalf, yCenter,  zHigh}, {0,1}}, {{ xHalf, yCenter,  zHigh}, {4,1}}, {{ xHalf, yCenter, zLow}, {4,0}},
-            {{-xHalf, yCenter,  zHigh}, {0,1}}, {{ xHalf, yCenter, zLow}, {4,0}}, {{-xHalf, yCenter, zLow}, {0,0}},
-        };
-        glGenVertexArrays(1, &wallFrontVAO);
-        glGenBuffers(1, &wallFrontVBO);
-        glBindVertexArray(wallFrontVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, wallFrontVBO);
-        glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(V), data.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void*)0);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(V), (void*)offsetof(V, uv));
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
-
-    // Back wall: normal +Y, center at (0, -maxCoord*2, 0)
-    {
-        float half = maxCoord * bgScale;
-        float zLow  = -0.5f * maxCoord;
-        float zHigh =  0.5f * maxCoord;
-        float yCenter = -maxCoord * bgScale;
-        std::vector<V> data = {
-            {{-half, yCenter, zLow }, {0,0}}, {{ half, yCenter, zLow }, {4,0}}, {{ half, yCenter, zHigh}, {4,1}},
-            {{-half, yCenter, zLow }, {0,0}}, {{ half, yCenter, zHigh}, {4,1}}, {{-half, yCenter, zHigh}, {0,1}},
-        };
-        glGenVertexArrays(1, &wallBackVAO);
-        glGenBuffers(1, &wallBackVBO);
-        glBindVertexArray(wallBackVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, wallBackVBO);
-        glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(V), data.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void*)0);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(V), (void*)offsetof(V, uv));
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
 }
 
-static void ensure_textures() {
-    if (!texOcean) {
-        const char* path = dayModeFlag ? "assets/textures/diffuse_ocean_day.png"
-                                       : "assets/textures/diffuse_ocean_night.png";
-        texOcean = gRenderer.get_or_load_texture(path);
-    }
-    if (!texOceanNormal) {
-        texOceanNormal = gRenderer.get_or_load_texture("assets/textures/normal_ocean.png");
-    }
-    if (!texSky) {
-        const char* path = dayModeFlag ? "assets/textures/diffuse_sky_day.png"
-                                       : "assets/textures/diffuse_sky_night.png";
-        texSky = gRenderer.get_or_load_texture(path);
-    }
+// Switch variants only once the requested one has streamed in; until then keep the old one.
+static void update_shown_variant() {
+    if (shownDayMode != dayModeFlag && gAssets.resident(oceanTex[dayModeFlag]) && gAssets.resident(skyTex[dayModeFlag]))
+        shownDayMode = dayModeFlag;
 }
 
 void draw() {
-    ensure_textures();
-    if (floorVAO && texOcean)
-        gRenderer.draw_raw(floorVAO, 6, GL_TRIANGLES, glm::mat4(1.0f), glm::vec4(1.0f), true, texOcean, texOceanNormal, true);
-    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
-    if (cullEnabled) glDisable(GL_CULL_FACE); // draw sky quads double-sided
-    if (wallVAO && texSky)
-        gRenderer.draw_raw(wallVAO, 6, GL_TRIANGLES, glm::mat4(1.0f), glm::vec4(1.0f), false, texSky);
-    if (wallRightVAO && texSky)
-        gRenderer.draw_raw(wallRightVAO, 6, GL_TRIANGLES, glm::mat4(1.0f), glm::vec4(1.0f), false, texSky);
-    if (wallFrontVAO && texSky)
-        gRenderer.draw_raw(wallFrontVAO, 6, GL_TRIANGLES, glm::mat4(1.0f), glm::vec4(1.0f), false, texSky);
-    if (wallBackVAO && texSky)
-        gRenderer.draw_raw(wallBackVAO, 6, GL_TRIANGLES, glm::mat4(1.0f), glm::vec4(1.0f), false, texSky);
-    if (cullEnabled) glEnable(GL_CULL_FACE);
+    update_shown_variant();
+    if (!backgroundVAO)
+        return;
+    GLuint texOcean = gAssets.texture(oceanTex[shownDayMode]);
+    GLuint texOceanNormal = gAssets.texture(oceanNormalTex);
+    GLuint texSky = gAssets.texture(skyTex[shownDayMode]);
+    if (texOcean)
+        gRenderer.draw_raw(backgroundVAO, floorRange.count, GL_TRIANGLES, glm::mat4(1.0f), glm::vec4(1.0f), true,
+                           texOcean, texOceanNormal, true, floorRange.first);
+    if (texSky) {
+        const Range& sky = is_sky_dome() ? domeRange : wallRange;
+        bool culling = gRenderer.face_culling();
+        gRenderer.set_face_culling(false); // sky is seen from inside, draw it double-sided
+        gRenderer.draw_raw(backgroundVAO, sky.count, GL_TRIANGLES, glm::mat4(1.0f), glm::vec4(1.0f), false,
+                           texSky, 0, false, sky.first);
+        gRenderer.set_face_culling(culling);
+    }
 }
 
 } // namespace background
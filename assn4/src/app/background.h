@@ -4,14 +4,15 @@
 
 namespace background {
 
-// Initialize floor geometry/texture; call once after renderer init.
+// Initialize floor and sky geometry (one vertex buffer) and textures; call once after renderer init.
 // maxCoord is the gameplay MAX_COORD to scale the floor size.
 void init(float maxCoord, bool dayMode);
 
 // Draw the floor. Assumes renderer frame has begun.
 void draw();
 
-// Optional: change day/night textures and reload if needed.
+// Optional: change day/night textures. Both variants are prefetched by init(), so this
+// never blocks; the new variant shows as soon as it is resident.
 void set_day_mode(bool dayMode);
 bool is_day_mode();
 
@@ -19,6 +20,11 @@ bool is_day_mode();
 void set_scale(float scale);
 float get_scale();
 
+// Optional: draw the sky as skydome.obj instead of the four walls. Falls back to the
+// walls if the model could not be loaded.
+void set_sky_dome(bool enabled);
+bool is_sky_dome();
+
 // Release GL resources (optional).
 void shutdown();
 
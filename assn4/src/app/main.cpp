@@ -1,6 +1,9 @@
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <string>
 #include <vector>
 #include <cmath>
 
@@ -12,12 +15,24 @@
 
 #include "core/globals/game_constants.h"
 #include "core/globals/camera.h"
+#include "core/base/frame_arena.h"
+#include "core/base/profiler.h"
 #include "core/base/scene_node.h"
 #include "core/render/renderer.h"
 #include "core/render/mesh.h"
+#include "core/render/asset_registry.h"
+#include "core/render/material.h"
+#include "core/render/shadow_map.h"
+#include "core/render/gpu_timer.h"
+#include "core/render/motion_blur.h"
+#include "core/render/render_target.h"
+#include "core/render/render_graph.h"
+#include "core/render/dynamic_resolution.h"
+#include "core/render/temporal_upsample.h"
 #include "game/entities/player.h"
 #include "game/entities/enemy.h"
 #include "app/background.h"
+#include "app/starfield.h"
 
 // Constants & simple types
 enum class GameState { Playing, GameOver, Exiting };
@@ -27,24 +42,50 @@ constexpr float PLAYER_LIGHT_RADIUS = 10.0f;
 constexpr float PLAYER_LIGHT_SPEED = 2.5f; // rad/sec
 constexpr float PLAYER_LIGHT_HEIGHT = 0.0f;
 constexpr float ENEMY_LIGHT_HEIGHT = 5.0f;
-// for shadow map
-const unsigned int SHADOW_WIDTH = 1024;
-const unsigned int SHADOW_HEIGHT = 1024;
+// for shadow map (the texel budget of one SHADOW_SIZE² layer is shared by all cascades)
+constexpr int SHADOW_SIZE = 1024;
+constexpr int SHADOW_DEFAULT_CASCADES = 3;
 static bool gShadowOn = false;
+static bool gShadowCacheOn = false;  // static casters come from the cached layer (off: nothing is static yet)
+static ShadowQuality gShadowQuality = ShadowQuality::Poisson8;
 // for motion blur
-static bool motionBlurOn = false;
+static MotionBlurMode motionBlurMode = MotionBlurMode::Off;
+// post effects can resolve at reduced resolution and upscale on the way to the screen
+constexpr float POST_HALF_RES_SCALE = 0.5f;
+static bool gHalfResPost = false;
+// the scene resolution follows the GPU frame time (--frame-budget <ms>, default one frame at FPS)
+static DynamicResolution dynamicResolution(1000.0 / FPS);
+// temporal upsampling: the scene renders jittered at no more than temporalScale and is
+// reconstructed at window resolution from the reprojected history
+constexpr float TEMPORAL_DEFAULT_SCALE = 0.5f;
+static bool gTemporalOn = false;
+static float temporalScale = TEMPORAL_DEFAULT_SCALE;
+// --benchmark: every shadow quality tier on a frozen scene, then every motion blur mode
+// and temporal upsampling at each internal scale on the running game (velocities are zero while frozen)
+constexpr int BENCHMARK_WARMUP_FRAMES = 60;
+constexpr int BENCHMARK_FRAMES = 300;
+constexpr float BENCHMARK_TEMPORAL_SCALES[] = { 0.5f, 0.7f, 1.0f };
+constexpr int BENCHMARK_TEMPORAL_STEPS = 3;
+// --submit-benchmark: CPU time of submit() + flush() at each draw count, one call per
+// draw against multi-draw indirect
+constexpr int SUBMIT_BENCHMARK_DRAWS[] = { 1000, 10000, 100000 };
+constexpr int SUBMIT_BENCHMARK_ROUNDS = 10;
+// game-over starfield, generated on the GPU; the seed changes with every game over
+constexpr int STAR_COUNT = 10000;
+constexpr float STAR_EXTENT = 500.0f;
+// resident asset budget (meshes + textures); unpinned assets beyond it are evicted LRU-first
+constexpr size_t ASSET_BUDGET_BYTES = 96u * 1024u * 1024u;
 
 // Global state (local TU scope)
 static GameState gameState = GameState::Playing;
-static GLuint starVAO = 0;
-static GLuint starVBO = 0;
-static GLsizei starVertexCount = 0;
+static uint32_t starSeed = 42;
 
 static GLuint boundingBoxVAO = 0;
 static GLuint boundingBoxVBO = 0;
 static GLsizei boundingBoxVertexCount = 0;
 
-static std::vector<float> starVertices;
+static MeshHandle sunMesh;
+static MaterialId sunMaterial = INVALID_MATERIAL;
 static std::vector<Enemy*> enemies;
 static Player* player = nullptr;
 static int prevTime = 0;
@@ -60,13 +101,25 @@ static float playerLightAngle = 0.0f;
 static bool gDayMode = true; // toggle manually for night build
 
 // for shadow map
-static GLuint depthMapFBO = 0;
-static GLuint depthMapTexture = 0;
-// for scene map
-static GLuint sceneFBO = 0;
-static GLuint colorTexture = 0;
-static GLuint velocityTexture = 0;
-static GLuint sceneDepthRBO = 0; // 리사이즈 시 다시 만들어야 하므로 보관
+static ShadowMap shadowMap;
+static GpuTimer shadowTimer;
+static GpuTimer sceneTimer;          // lighting pass, where the shadow filter cost shows up
+static GpuTimer postTimer;           // motion blur prepasses + resolve
+static int shadowFrames = 0;         // since the last stats reset
+static int staticShadowRenders = 0;
+static bool benchmarkOn = false;
+static int benchmarkStep = 0;
+static int benchmarkFrame = 0;
+// for the frame graph (passes are declared every frame, targets come from its pool)
+static RenderGraph renderGraph;
+static RenderTargetDesc sceneDesc;   // colour RGBA16F, velocity RG16F, depth texture sampled by the blur resolve
+static RenderTargetDesc sceneColorDesc;   // motion blur off: colour + depth only, presented directly
+static RenderTargetDesc postDesc;    // motion blur resolve, full or half resolution
+static MotionBlurTiles blurTiles;
+static TemporalUpsampler temporal;
+static int temporalHistoryFrames = 0;   // 0: the history holds nothing usable
+static glm::vec2 sceneJitterNdc(0.0f);
+static glm::vec2 sceneJitterPx(0.0f);   // read by the temporal pass, too large to capture inline
 static GLuint quadVAO = 0;
 static GLuint quadVBO = 0;
 
@@ -75,6 +128,7 @@ static void set_projection_matrix(ProjectionType type);
 static void reshape (int w, int h);
 static void display (void);
 static void timer(int value);
+static void close_window();
 static void update(void);
 
 static void key_down(unsigned char key, int x, int y);
@@ -89,14 +143,28 @@ static bool enemies_destroyed();
 static void draw_ending_msg(const char* line1, const char* line2, int w, int h);
 static void draw_game_over(const char* msg);
 
-static void init_stars();
+static void preload_assets();
 static void draw_stars();
 static void init_bounding_box();
 static void draw_bounding_box();
 
-static void init_shadow_map();
-static void init_scene_map();
-static void resize_scene_map(int w, int h);
+static void draw_static_shadow_casters();
+static void set_shadow_quality(ShadowQuality quality);
+static void set_motion_blur_mode(MotionBlurMode mode);
+static void print_gpu_stats();
+static void cycle_lod_bias();
+static void start_benchmark();
+static void apply_benchmark_step();
+static void benchmark_frame();
+static double time_submit(const std::vector<const Mesh*>& meshes, const std::vector<glm::mat4>& models);
+static void run_submit_benchmark();
+
+static void update_dynamic_resolution();
+static void init_render_targets();
+static void build_frame_graph();
+static void shadow_pass();
+static void lighting_pass();
+static void motion_blur_pass(RGResource scene, RGResource color, RGResource neighborMax);
 void draw_screen_quad();
 
 
@@ -112,10 +180,20 @@ int main(int argc, char** argv) {
     // Initialize GLEW and Renderer
     glewExperimental = GL_TRUE;
     glewInit();
-    // init shadow map (init depthFBO and depth texture) and scene map (init sceneFBO and color/velocity texture)
-    init_shadow_map();
-    init_scene_map();
+    // init shadow map (depth texture array, one layer per cascade) and the off-screen scene/post targets
+    shadowMap.init(SHADOW_SIZE, SHADOW_DEFAULT_CASCADES);
+    // Casters live in the play area; the floor below it receives their shadows.
+    shadowMap.set_bounds(glm::vec3(-MAX_COORD * 1.25f, -MAX_COORD * 1.25f, -MAX_COORD * 0.5f),
+                         glm::vec3( MAX_COORD * 1.25f,  MAX_COORD * 1.25f,  MAX_COORD * 0.25f));
+    shadowTimer.init();
+    sceneTimer.init();
+    postTimer.init();
+    init_render_targets();
     gRenderer.init();
+    blurTiles.init();
+    temporal.init();
+    starfield::init();
+    preload_assets();
 
     // OpenGL states configuration
     glEnable(GL_BLEND);
@@ -123,7 +201,7 @@ int main(int argc, char** argv) {
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LEQUAL);
     glClearDepth(1.0f);
-    glEnable(GL_CULL_FACE);
+    gRenderer.set_face_culling(true);
     glCullFace(GL_BACK);
     glPointSize(2.0f);
 
@@ -139,6 +217,10 @@ int main(int argc, char** argv) {
     glutKeyboardUpFunc(key_up);
     glutSpecialUpFunc(special_key_up);
     glutTimerFunc(0, timer, 0);
+    // Free GL objects while the context still exists, then return from glutMainLoop so the
+    // stats and the profile report below still run.
+    glutCloseFunc(close_window);
+    glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
 
     prevTime = glutGet(GLUT_ELAPSED_TIME);
 
@@ -179,11 +261,43 @@ int main(int argc, char** argv) {
         if (static_cast<int>(initialLights.size()) >= MAX_POINT_LIGHTS)
             break;
     }
-    gRenderer.set_lights(dirLight, initialLights);
+    gRenderer.set_lights(dirLight, initialLights.data(), initialLights.size());
     gRenderer.set_view_position(cameraPos);
+    set_shadow_quality(gShadowQuality);
+
+    bool submitBenchmark = false;
+    const char* profileReport = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--benchmark")
+            start_benchmark();
+        else if (arg == "--submit-benchmark")
+            submitBenchmark = true;
+        else if (arg == "--arena-debug")
+            gFrameArena.set_poison(true);
+        else if (arg == "--assert-no-alloc") {
+            if (!alloc_tracker::enabled())
+                std::cerr << "[Profiler] --assert-no-alloc needs a build with ALLOC_TRACKING=1" << std::endl;
+            gProfiler.set_assert_alloc_free(true);
+        }
+        else if (arg == "--profile-report" && i + 1 < argc)
+            profileReport = argv[++i];
+        else if (arg == "--frame-budget" && i + 1 < argc) {
+            double budget = std::atof(argv[++i]);
+            if (budget > 0.0)
+                dynamicResolution.set_budget(budget);
+        }
+    }
 
-
-    glutMainLoop();
+    if (submitBenchmark) {
+        run_submit_benchmark();
+        gRenderer.shutdown();
+    }
+    else
+        glutMainLoop();
+    gAssets.print_stats();
+    if (profileReport)
+        gProfiler.export_report(profileReport);
     
     for (auto enemy : enemies)
         delete enemy;
@@ -199,6 +313,9 @@ static void set_projection_matrix(ProjectionType type) {
 
     projectionType = type;
     cameraTargetObject = nullptr;
+    gProfiler.restart_warmup();   // resizes and game-state changes
+    temporalHistoryFrames = 0;   // camera cut or new aspect
+    gRenderer.reset_view_history();
 
     if(type == ProjectionType::Perspective) {
         projection = glm::perspective(glm::radians(90.0f), aspect, 0.1f, 500.0f);
@@ -211,6 +328,7 @@ static void set_projection_matrix(ProjectionType type) {
         cameraPos = glm::vec3(0, -20, 10);
     }
 
+    projectionMatrix = projection;
     gRenderer.set_projection(projection);
     update_camera();
 }
@@ -222,10 +340,15 @@ static void reshape (int w, int h) {
     glViewport (0, 0, w, h);
     set_projection_matrix(projectionType);
     // 창 크기 변경 시 모션 블러용 컬러/속도/깊이버퍼를 새 해상도로 다시 할당해야 깨짐을 방지한다.
-    resize_scene_map(w, h);
+    renderGraph.resize(w, h);
 }
 
 static void display (void) {
+    gProfiler.begin_frame();
+    ProfileScope zone("display", ZONE_ALLOC_FREE);
+    gFrameArena.begin_frame();
+    gAssets.begin_frame();
+    gRenderer.begin_frame();
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     update_camera();
@@ -233,45 +356,10 @@ static void display (void) {
     gRenderer.set_view_position(eye); 
     ShadingMode prevShading = gRenderer.get_shading_mode();
 
-    // 1. Depth pass (generate shadow map)
-    if (gShadowOn) {
-        gRenderer.set_shading_mode(ShadingMode::DepthOnly);
-        gRenderer.set_light_space_matrix();
-
-        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-        glClear(GL_DEPTH_BUFFER_BIT);
-
-        sceneRoot.draw();
-        gRenderer.set_shading_mode(prevShading);
-    }
-    
-    // 2. Lighting pass (regular rendering with shadows)
-    glViewport(0, 0, windowWidth, windowHeight);
-    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
-    
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    gRenderer.set_shadow_map(gShadowOn ? depthMapTexture : 0);
-
-    background::draw();
-    sceneRoot.draw();
-    draw_bounding_box();
-    
-    // 3. Motion Blur pass
-    gRenderer.set_shading_mode(ShadingMode::MotionBlur);
-    gRenderer.set_motion_blur(motionBlurOn);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDisable(GL_DEPTH_TEST);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, colorTexture);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, velocityTexture);
-
-    draw_screen_quad();
-    glEnable(GL_DEPTH_TEST);
+    update_dynamic_resolution();
+    build_frame_graph();
+    renderGraph.execute();
+    postTimer.end();
 
     // return to original shading mode
     gRenderer.set_shading_mode(prevShading);
@@ -291,6 +379,12 @@ static void display (void) {
         draw_game_over(overlayMsg);
     
     glutSwapBuffers();
+    if (benchmarkOn)
+        benchmark_frame();
+}
+
+static void close_window() {
+    gRenderer.shutdown();
 }
 
 static void timer(int /*value*/) {
@@ -301,6 +395,7 @@ static void timer(int /*value*/) {
 
 // Game loop & state
 static void update(void) {
+    ProfileScope zone("update", ZONE_ALLOC_FREE);
     int curTime = glutGet(GLUT_ELAPSED_TIME);
     float deltaTime = (curTime - prevTime) / 1000.0f;
     prevTime = curTime;
@@ -326,7 +421,7 @@ static void update(void) {
                                                          std::sin(playerLightAngle) * PLAYER_LIGHT_RADIUS,
                                                          PLAYER_LIGHT_HEIGHT);
 
-    std::vector<PointLight> pointLights;
+    FrameVector<PointLight> pointLights;
     pointLights.reserve(MAX_POINT_LIGHTS);
     pointLights.push_back(playerLight); // slot 0 = orbiting player light
 
@@ -339,9 +434,12 @@ static void update(void) {
             break;
     }
 
-    gRenderer.set_lights(dirLight, pointLights);
+    gRenderer.set_lights(dirLight, pointLights.data(), pointLights.size());
 
-    sceneRoot.update(deltaTime);
+    {
+        ProfileScope sceneZone("scene update");
+        sceneRoot.update(deltaTime);
+    }
     check_and_handle_game_over();
 }
 
@@ -351,7 +449,6 @@ static void reset_game() {
     gameState = GameState::Playing;
     playerDirection = ZERO;
     playerPrevDirection = ZERO;
-    starVertices.clear();
     for (auto enemy : enemies)
         enemy->reset();
     player->reset();
@@ -361,7 +458,7 @@ static void reset_game() {
 static void check_and_handle_game_over() {
     if (enemies_destroyed() || !player->get_isActive()) {
         gameState = GameState::GameOver;
-        init_stars();
+        ++starSeed;
         player->set_isActive(true);
         player->set_isRecovery(false);
         player->set_direction(ZERO);
@@ -395,6 +492,8 @@ static bool enemies_destroyed() {
 
 // Input handling
 static void key_down(unsigned char key, int /*x*/, int /*y*/) {
+    if (key != ' ')
+        gProfiler.restart_warmup();   // toggles may (re)allocate targets and buffers
     if (gameState == GameState::GameOver) {
         if (key == 'r' || key == 'R') 
             reset_game();
@@ -416,6 +515,11 @@ static void key_down(unsigned char key, int /*x*/, int /*y*/) {
                 gDayMode = !gDayMode;
                 background::set_day_mode(gDayMode);
                 break;
+            case 'y':
+            case 'Y':
+                background::set_sky_dome(!background::is_sky_dome());
+                std::cout << "[Background] Sky: " << (background::is_sky_dome() ? "dome" : "walls") << std::endl;
+                break;
             case 'w':
             case 'W':
                 gRenderer.switch_shading_mode();
@@ -432,7 +536,69 @@ static void key_down(unsigned char key, int /*x*/, int /*y*/) {
                 break;
             case 'm':
             case 'M':
-                motionBlurOn = !motionBlurOn;
+                set_motion_blur_mode(static_cast<MotionBlurMode>((static_cast<int>(motionBlurMode) + 1) % MOTION_BLUR_MODE_COUNT));
+                std::cout << "[MotionBlur] " << motion_blur_mode_name(motionBlurMode) << std::endl;
+                break;
+            case 'd':
+            case 'D':
+                dynamicResolution.set_enabled(!dynamicResolution.is_enabled());
+                std::cout << "[DynRes] " << (dynamicResolution.is_enabled() ? "on" : "off") << ", budget "
+                          << dynamicResolution.get_budget() << " ms" << std::endl;
+                break;
+            case 'u':
+            case 'U':
+                gTemporalOn = !gTemporalOn;
+                temporalHistoryFrames = 0;
+                postTimer.reset();
+                std::cout << "[Temporal] upsampling " << (gTemporalOn ? "on" : "off") << ", internal scale "
+                          << temporalScale << std::endl;
+                break;
+            case 'h':
+            case 'H':
+                gHalfResPost = !gHalfResPost;
+                postTimer.reset();
+                std::cout << "[Post] " << (gHalfResPost ? "half" : "full") << " resolution, targets "
+                          << renderGraph.pooled_bytes() / 1024 << " KB" << std::endl;
+                break;
+            case 'k':
+            case 'K':
+                shadowMap.set_cascade_count(shadowMap.cascade_count() % MAX_SHADOW_CASCADES + 1);
+                std::cout << "[Shadow] " << shadowMap.cascade_count() << " cascade(s), "
+                          << shadowMap.layer_resolution() << "^2 per layer, "
+                          << shadowMap.byte_size() / 1024 << " KB" << std::endl;
+                break;
+            case 'o':
+            case 'O':
+                gShadowCacheOn = !gShadowCacheOn;
+                if (!shadowMap.set_static_cache(gShadowCacheOn))
+                    gShadowCacheOn = false;
+                shadowTimer.reset();
+                shadowFrames = staticShadowRenders = 0;
+                std::cout << "[Shadow] Static layer cache " << (gShadowCacheOn ? "on" : "off") << ", "
+                          << shadowMap.byte_size() / 1024 << " KB" << std::endl;
+                break;
+            case 'f':
+            case 'F':
+                set_shadow_quality(static_cast<ShadowQuality>((static_cast<int>(gShadowQuality) + 1) % SHADOW_QUALITY_COUNT));
+                std::cout << "[Shadow] Quality: " << shadow_quality_name(gShadowQuality) << std::endl;
+                break;
+            case 'l':
+            case 'L':
+                cycle_lod_bias();
+                break;
+            case 'i':
+            case 'I':
+                gRenderer.set_indirect_draws(!gRenderer.indirect_draws());
+                std::cout << "[Indirect] " << (gRenderer.indirect_draws() ? "multi-draw indirect" : "one call per draw")
+                          << std::endl;
+                break;
+            case 'p':
+            case 'P':
+                print_gpu_stats();
+                break;
+            case 'a':
+            case 'A':
+                std::cout << "[Assets] Retrying " << gAssets.retry_failed() << " failed load(s)" << std::endl;
                 break;
             case 27: // ESC
                 gameState = GameState::Exiting;
@@ -565,7 +731,7 @@ static void draw_game_over(const char* msg) {
     glPushMatrix();
     glLoadIdentity();
 
-    glDisable(GL_CULL_FACE);
+    gRenderer.set_face_culling(false);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -586,50 +752,50 @@ static void draw_game_over(const char* msg) {
     glMatrixMode(GL_MODELVIEW);
 }
 
-// Starfield & bounding box helpers
-static void init_stars() {
-    starVertices.clear();
-    srand(42);
-    for (int i = 0; i < 10000; ++i) {
-        starVertices.push_back(rand() % 1000 - 500);
-        starVertices.push_back(rand() % 1000 - 500);
-        starVertices.push_back(rand() % 1000 - 500);
-    }
-
-    // [V1] Require VAO and VBO for stars
-    starVertexCount = static_cast<GLsizei>(starVertices.size() / 3);
-    if (!starVAO)
-        glGenVertexArrays(1, &starVAO);         // request VAO handle
-    if (!starVBO)
-        glGenBuffers(1, &starVBO);              // request VBO handle
-
-    // [V2] Bind VAO and VBO 
-    glBindVertexArray(starVAO);                 // make VAO current so later calls configure it
-    glBindBuffer(GL_ARRAY_BUFFER, starVBO);     // bind vertex buffer for position data
-
-    // [V3] VBO data upload
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(starVertices.size() * sizeof(float)), 
-                starVertices.data(), GL_STATIC_DRAW);
-    // [V4] VAO attribute setup
-    glEnableVertexAttribArray(0);                                // enable attribute slot 0 (position)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr); // describe layout: 3 floats per vertex
-
-    // [V5] Unbind to avoid accidental modification
-    glBindBuffer(GL_ARRAY_BUFFER, 0);   
-    glBindVertexArray(0);               
+// Asset residency
+static void preload_assets() {
+    // Gameplay meshes and textures are pinned so the budget can never evict them mid-game.
+    static const char* pinnedMeshes[] = {
+        "assets/models/jet.obj", "assets/models/starship.obj", "assets/models/sphere.obj",
+        "assets/models/sonic.obj", "assets/models/rice.obj", "assets/models/square.obj",
+        "assets/models/upper_arm.obj", "assets/models/lower_arm.obj", "assets/models/healthbar_box.obj",
+    };
+    static const char* pinnedTextures[] = {
+        "assets/textures/normal_quilt.png", "assets/textures/normal_organic.png",
+        "assets/textures/normal_flat.png",
+    };
+    // Small diffuse maps share one texture array (or atlas) instead of separate GL textures.
+    static const std::vector<std::string> packedDiffuse = {
+        "assets/textures/diffuse_jet.png", "assets/textures/diffuse_starship.png",
+        "assets/textures/diffuse_primary.png", "assets/textures/diffuse_sonic_1.png",
+        "assets/textures/diffuse_sonic_2.png",
+    };
+
+    gAssets.set_budget(ASSET_BUDGET_BYTES);
+    for (const char* path : pinnedMeshes) {
+        MeshHandle handle = gAssets.mesh_handle(path);
+        gAssets.pin(handle);
+        gAssets.preload(handle);
+    }
+    for (const char* path : pinnedTextures) {
+        TextureHandle handle = gAssets.texture_handle(path);
+        gAssets.pin(handle);
+        gAssets.preload(handle);
+    }
+    gMaterials.pack_diffuse_textures(packedDiffuse);
+    sunMesh = gAssets.mesh_handle("assets/models/sphere.obj");
+    sunMaterial = gMaterials.create("sun", {"", "", glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)});
 }
 
+// Starfield & bounding box helpers
 static void draw_stars() {
-    if (!starVAO || starVertexCount == 0)
-        return;
+    starfield::draw(projectionMatrix * cameraMatrix, STAR_COUNT, starSeed, STAR_EXTENT);
 
-    gRenderer.draw_raw(starVAO, starVertexCount, GL_POINTS, glm::mat4(1.0f), glm::vec4(1.0f), false);
-
-    auto sunMesh = load_mesh("assets/models/sphere.obj");
-    if (sunMesh) {
+    if (auto sun = gAssets.mesh(sunMesh)) {
         glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(-60, 620, 20));
         model = glm::scale(model, glm::vec3(100.0f));
-        gRenderer.draw_mesh(*sunMesh, model, model, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+        gRenderer.submit(*sun, model, model, sunMaterial);
+        gRenderer.flush();
     }
 }
 
@@ -695,147 +861,338 @@ static void draw_bounding_box() {
                        false);
 }
 
-static void init_shadow_map() {
-    // Generate Framebuffer Object (FBO)
-    glGenFramebuffers(1, &depthMapFBO);
-    
-    // Generate depth texture (Shadow map)
-    glGenTextures(1, &depthMapTexture);
-    glBindTexture(GL_TEXTURE_2D, depthMapTexture);
-    
-    // Configure texture to store only depth components
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, 
-                 SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-    
-    // Set texture filtering parameters (Mipmaps are not needed)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    
-    // Set texture wrapping parameters (Areas outside the shadow map are set to 1.0 to prevent shadow projection)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-    
-    // Attach the depth texture to the FBO's depth buffer
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMapTexture, 0);
-    
-    // Disable writes to the color buffer (We only need depth data)
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    
-    // Unbind the framebuffer (Switch back to default)
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+// Everything that never moves. Call shadowMap.invalidate_static_layer() whenever this set changes.
+static void draw_static_shadow_casters() {
+    sceneRoot.draw_shadow_casters(ShadowCaster::Static);
+    gRenderer.flush();
 }
 
-static void init_scene_map() {
-    // 1. Create the Framebuffer Object (FBO)
-    glGenFramebuffers(1, &sceneFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
-    
-    // 2. Create the Color Texture (Standard screen output: RGB)
-    glGenTextures(1, &colorTexture);
-    glBindTexture(GL_TEXTURE_2D, colorTexture);
-    // Allocate storage for a 4-channel 16-bit floating point texture (RGBA16F)
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, windowWidth, windowHeight, 0, GL_RGBA, GL_FLOAT, NULL);
-    
-    // [Mandatory] Set filtering parameters (Texture would appear black otherwise)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Attach to FBO (Attachment slot 0)
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
-    
-    // 3. Create the Velocity Texture (To store motion vectors: RGBA16F for precision)
-    glGenTextures(1, &velocityTexture);
-    glBindTexture(GL_TEXTURE_2D, velocityTexture);
-    // Allocate storage for a 4-channel 16-bit floating point texture (RGBA16F)
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, windowWidth, windowHeight, 0, GL_RGBA, GL_FLOAT, NULL);
+static void set_shadow_quality(ShadowQuality quality) {
+    gShadowQuality = quality;
+    shadowMap.set_quality(quality);
+    gRenderer.set_shadow_filter(shadow_filter(quality));
+    sceneTimer.reset();
+}
 
-    
-    // [Mandatory] Set filtering parameters (NEAREST is recommended for velocity data to prevent interpolation, 
-    // but LINEAR is also possible for smoothness)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    // Attach to FBO (Attachment slot 1)
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, velocityTexture, 0);
-
-    // 4. Create the Depth Buffer (Render Buffer Object - RBO)
-    // Depth Test will not work without a depth buffer attached to the FBO, leading to incorrect object drawing order.
-    glGenRenderbuffers(1, &sceneDepthRBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, sceneDepthRBO);
-    // Allocate storage for the depth component
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, windowWidth, windowHeight);
-    // Attach to FBO
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, sceneDepthRBO);
-
-    // 5. Set Draw Buffers (Multi-Render Target - MRT setup)
-    GLenum attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-    glDrawBuffers(2, attachments);
-
-    // 6. Check status
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "ERROR::FRAMEBUFFER:: Scene Framebuffer is not complete!" << std::endl;
-    }
-
-    // Return to the default framebuffer after setup is complete
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-}
-
-static void resize_scene_map(int w, int h) {
-    if (sceneFBO == 0) {
-        // 처음 호출 시 FBO가 없으면 초기화부터 수행
-        init_scene_map();
+static void set_motion_blur_mode(MotionBlurMode mode) {
+    motionBlurMode = mode;
+    postTimer.reset();
+}
+
+static void print_gpu_stats() {
+    std::cout << "[Shadow] pass " << shadowTimer.average_ms() << " ms GPU avg over "
+              << shadowTimer.sample_count() << " frames (last " << shadowTimer.last_ms() << " ms), "
+              << "static cache " << (gShadowCacheOn ? "on" : "off");
+    if (gShadowCacheOn)
+        std::cout << ", static layer redrawn " << staticShadowRenders << "/" << shadowFrames << " frames";
+    std::cout << std::endl;
+    std::cout << "[Shadow] lighting pass " << sceneTimer.average_ms() << " ms GPU avg with "
+              << shadow_quality_name(gShadowQuality) << " filtering" << std::endl;
+    std::cout << "[MotionBlur] post pass " << postTimer.average_ms() << " ms GPU avg, "
+              << motion_blur_mode_name(motionBlurMode) << std::endl;
+    std::cout << "[DynRes] " << (dynamicResolution.is_enabled() ? "on" : "off") << ", scale "
+              << dynamicResolution.get_scale() << ", GPU frame " << dynamicResolution.smoothed_ms()
+              << " ms smoothed, budget " << dynamicResolution.get_budget() << " ms" << std::endl;
+    std::cout << "[Temporal] " << (gTemporalOn ? "on" : "off") << ", internal scale "
+              << std::min(dynamicResolution.get_scale(), temporalScale) << std::endl;
+    std::cout << "[LOD] bias " << gRenderer.get_lod_bias() << ", " << gRenderer.triangles_submitted()
+              << " triangles submitted last frame (" << gRenderer.triangles_full_detail() << " at full detail)" << std::endl;
+    std::cout << "[MeshBuffer] " << gMeshBuffer.used_vertices() << " vertices, " << gMeshBuffer.used_indices()
+              << " indices resident, " << gMeshBuffer.byte_size() / 1024 << " KB allocated" << std::endl;
+    std::cout << "[Indirect] " << (gRenderer.indirect_draws() ? "multi-draw indirect" : "one call per draw") << ", "
+              << gRenderer.draw_calls() << " draw calls from the queues last frame" << std::endl;
+    std::cout << "[FrameArena] " << gFrameArena.last_frame_bytes() / 1024.0 << " KB last frame, peak "
+              << gFrameArena.peak_bytes() / 1024.0 << " KB of " << gFrameArena.capacity() / 1024 << " KB, "
+              << gFrameArena.last_frame_fallbacks() << " heap fallbacks" << (gFrameArena.poisoning() ? ", poisoning" : "")
+              << std::endl;
+    gProfiler.print(std::cout);
+    std::cout << "[Objects] " << gObjectCold.live_count() << " live, " << sizeof(Object) << " B in place + "
+              << sizeof(ObjectCold) << " B cold record each" << std::endl;
+    std::cout << "[RenderGraph] " << renderGraph.pass_count() - renderGraph.culled_count() << "/"
+              << renderGraph.pass_count() << " passes live, " << renderGraph.pooled_count() << " pooled targets, "
+              << renderGraph.pooled_bytes() / 1024 << " KB" << std::endl;
+}
+
+// 1 → 2 → 0 (full detail) → 0.5 → 1
+static void cycle_lod_bias() {
+    static const float biases[] = {1.0f, 2.0f, 0.0f, 0.5f};
+    static int index = 0;
+    index = (index + 1) % static_cast<int>(std::size(biases));
+    gRenderer.set_lod_bias(biases[index]);
+    std::cout << "[LOD] bias " << biases[index] << (biases[index] == 0.0f ? " (full detail)" : "") << std::endl;
+}
+
+static void start_benchmark() {
+    benchmarkOn = true;
+    dynamicResolution.set_enabled(false);   // every step at full resolution
+    benchmarkStep = 0;
+    gShadowOn = true;
+    gRenderer.set_shading_mode(ShadingMode::PhongNormalMap);
+    std::cout << "[Benchmark] " << windowWidth << "x" << windowHeight << ", "
+              << shadowMap.cascade_count() << " cascade(s), " << BENCHMARK_FRAMES << " frames per step" << std::endl;
+    apply_benchmark_step();
+}
+
+// Steps [0, SHADOW_QUALITY_COUNT) time the shadow tiers, then the motion blur modes,
+// then temporal upsampling at each of BENCHMARK_TEMPORAL_SCALES.
+static void apply_benchmark_step() {
+    benchmarkFrame = 0;
+    int blurStep = benchmarkStep - SHADOW_QUALITY_COUNT;
+    int temporalStep = blurStep - MOTION_BLUR_MODE_COUNT;
+    if (benchmarkStep < SHADOW_QUALITY_COUNT) {
+        gPaused = true;
+        set_motion_blur_mode(MotionBlurMode::Off);
+        set_shadow_quality(static_cast<ShadowQuality>(benchmarkStep));
+    }
+    else if (blurStep < MOTION_BLUR_MODE_COUNT) {
+        gPaused = false;
+        set_shadow_quality(ShadowQuality::Poisson8);
+        set_motion_blur_mode(static_cast<MotionBlurMode>(blurStep));
+    }
+    else {
+        set_motion_blur_mode(MotionBlurMode::Off);
+        gTemporalOn = true;
+        temporalScale = BENCHMARK_TEMPORAL_SCALES[temporalStep];
+        temporalHistoryFrames = 0;
+    }
+}
+
+static void benchmark_frame() {
+    ++benchmarkFrame;
+    if (benchmarkFrame == BENCHMARK_WARMUP_FRAMES) {
+        shadowTimer.reset();
+        sceneTimer.reset();
+        postTimer.reset();
+        return;
+    }
+    if (benchmarkFrame < BENCHMARK_WARMUP_FRAMES + BENCHMARK_FRAMES)
         return;
+
+    if (benchmarkStep < SHADOW_QUALITY_COUNT)
+        std::cout << "[Benchmark] shadow " << shadow_quality_name(gShadowQuality)
+                  << ": shadow pass " << shadowTimer.average_ms() << " ms, lighting pass "
+                  << sceneTimer.average_ms() << " ms GPU (" << sceneTimer.sample_count() << " samples)" << std::endl;
+    else if (!gTemporalOn)
+        std::cout << "[Benchmark] motion blur " << motion_blur_mode_name(motionBlurMode)
+                  << ": lighting pass " << sceneTimer.average_ms() << " ms, post pass " << postTimer.average_ms()
+                  << " ms GPU (" << postTimer.sample_count() << " samples)" << std::endl;
+    else
+        std::cout << "[Benchmark] temporal upsampling from " << temporalScale
+                  << ": lighting pass " << sceneTimer.average_ms() << " ms, post pass " << postTimer.average_ms()
+                  << " ms GPU (" << postTimer.sample_count() << " samples)" << std::endl;
+
+    if (++benchmarkStep == SHADOW_QUALITY_COUNT + MOTION_BLUR_MODE_COUNT + BENCHMARK_TEMPORAL_STEPS) {
+        glutLeaveMainLoop();
+        return;
+    }
+    apply_benchmark_step();
+}
+
+// Average CPU time of submitting and flushing one draw per model matrix; a first
+// untimed round loads textures and sizes the buffers.
+static double time_submit(const std::vector<const Mesh*>& meshes, const std::vector<glm::mat4>& models) {
+    using Clock = std::chrono::steady_clock;
+    double totalMs = 0.0;
+    for (int round = 0; round <= SUBMIT_BENCHMARK_ROUNDS; ++round) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < models.size(); ++i)
+            gRenderer.submit(*meshes[i % meshes.size()], models[i], models[i], static_cast<MaterialId>(i % gMaterials.size()));
+        gRenderer.flush();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        glFinish();   // keep this round's GPU work out of the next one
+        if (round > 0)
+            totalMs += ms;
+    }
+    return totalMs / SUBMIT_BENCHMARK_ROUNDS;
+}
+
+static void run_submit_benchmark() {
+    static const char* meshPaths[] = {
+        "assets/models/jet.obj", "assets/models/starship.obj", "assets/models/sphere.obj", "assets/models/rice.obj",
+    };
+    std::vector<const Mesh*> meshes;
+    for (const char* path : meshPaths)
+        if (auto mesh = gAssets.mesh(gAssets.mesh_handle(path)))
+            meshes.push_back(mesh.get());
+    if (meshes.empty() || gMaterials.size() == 0) {
+        std::cerr << "[Benchmark] No meshes or materials to submit" << std::endl;
+        return;
+    }
+
+    bool indirect = gRenderer.indirect_draws();
+    gRenderer.set_shading_mode(ShadingMode::Phong);
+    std::cout << "[Benchmark] submit + flush CPU time, " << meshes.size() << " meshes, " << gMaterials.size()
+              << " materials" << (indirect ? "" : " (multi-draw indirect unsupported, both columns loop)") << std::endl;
+    for (int draws : SUBMIT_BENCHMARK_DRAWS) {
+        std::vector<glm::mat4> models(draws);
+        for (int i = 0; i < draws; ++i)
+            models[i] = glm::translate(glm::mat4(1.0f), glm::vec3(i % 100 - 50, (i / 100) % 100 - 50, -(i / 10000)));
+
+        gRenderer.set_indirect_draws(false);
+        double loopMs = time_submit(meshes, models);
+        gRenderer.set_indirect_draws(true);
+        double indirectMs = time_submit(meshes, models);
+        std::cout << "[Benchmark] " << draws << " draws: one call per draw " << loopMs << " ms, multi-draw indirect "
+                  << indirectMs << " ms" << std::endl;
     }
+    gRenderer.set_indirect_draws(indirect);
+}
+
+// Feeds last frame's GPU time (shadow + lighting + post) to the controller.
+static void update_dynamic_resolution() {
+    double gpuMs = sceneTimer.last_ms() + postTimer.last_ms() + (gShadowOn ? shadowTimer.last_ms() : 0.0);
+    if (dynamicResolution.update(gpuMs))
+        std::cout << "[DynRes] scale " << dynamicResolution.get_scale() << " (GPU frame "
+                  << dynamicResolution.smoothed_ms() << " ms)" << std::endl;
+}
+
+static void init_render_targets() {
+    sceneDesc.color = { {GL_RGBA16F, GL_LINEAR}, {GL_RG16F, GL_NEAREST} };
+    sceneDesc.depth = true;
+    sceneColorDesc.color = { {GL_RGBA16F, GL_LINEAR} };
+    sceneColorDesc.depth = true;
+    postDesc.color = { {GL_RGBA16F, GL_LINEAR} };
+    renderGraph.resize(windowWidth, windowHeight);
+}
+
+// Declares this frame's passes. Anything the presented image does not depend on
+// (the tile prepasses outside reconstruction mode, the whole blur when it is off) is culled.
+static void build_frame_graph() {
+    renderGraph.reset();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+    // 1. Depth pass (generate shadow map), one layer per cascade
+    RGResource shadow = RG_NONE;
+    if (gShadowOn) {
+        shadow = renderGraph.import("shadow map", shadowMap.texture());
+        renderGraph.add_pass("shadow", {}, shadow, shadow_pass);
+    }
 
-    // 기존 텍스처/렌더버퍼를 삭제하고 새 크기로 재할당 (리사이즈 후 블러 깨짐 방지)
-    if (colorTexture) { glDeleteTextures(1, &colorTexture); colorTexture = 0; }
-    if (velocityTexture) { glDeleteTextures(1, &velocityTexture); velocityTexture = 0; }
-    if (sceneDepthRBO) { glDeleteRenderbuffers(1, &sceneDepthRBO); sceneDepthRBO = 0; }
+    // 2. Lighting pass (regular rendering with shadows). Without motion blur or temporal
+    //    upsampling nothing reads velocity or depth, so the pass renders straight into the window.
+    //    Below full scale the target is upscaled by the resolve or by the final blit.
+    bool blurOn = motionBlurMode != MotionBlurMode::Off;
+    float sceneScale = dynamicResolution.get_scale();
+    if (gTemporalOn)
+        sceneScale = std::min(sceneScale, temporalScale);
+    sceneDesc.scale = sceneColorDesc.scale = sceneScale;
+    RGResource scene = renderGraph.create("scene", (blurOn || gTemporalOn) ? sceneDesc : sceneColorDesc);
+    renderGraph.add_pass("lighting", {shadow}, scene, lighting_pass);
+
+    // 3. Temporal upsampling: this frame's jittered samples + reprojected history → window resolution
+    RGResource color = scene;
+    sceneJitterNdc = glm::vec2(0.0f);
+    if (gTemporalOn) {
+        sceneJitterPx = temporal.jitter_px();
+        sceneJitterNdc = 2.0f * sceneJitterPx / glm::vec2(sceneDesc.scaled(windowWidth), sceneDesc.scaled(windowHeight));
+        RGResource history[2] = {
+            renderGraph.persistent("temporal history 0", TemporalUpsampler::history_desc()),
+            renderGraph.persistent("temporal history 1", TemporalUpsampler::history_desc()),
+        };
+        RGResource previous = history[1 - temporal.history_index()];
+        color = history[temporal.history_index()];
+        bool historyValid = temporalHistoryFrames > 0;
+        renderGraph.add_pass("temporal", {scene, previous}, color, [scene, previous, historyValid] {
+            temporal.resolve(renderGraph.texture(scene, 0), renderGraph.texture(scene, 1),
+                             renderGraph.texture(previous), sceneJitterPx, historyValid, draw_screen_quad);
+        });
+        temporal.next_frame();
+        ++temporalHistoryFrames;
+    }
 
-    // Color texture
-    glGenTextures(1, &colorTexture);
-    glBindTexture(GL_TEXTURE_2D, colorTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    // 4. Motion blur: velocity reduced to tiles for the reconstruction filter, then the resolve
+    RGResource tileMax = renderGraph.create("tile max", MotionBlurTiles::target_desc(sceneScale));
+    renderGraph.add_pass("tile max", {scene}, tileMax, [scene] {
+        blurTiles.draw_tile_max(renderGraph.texture(scene, 1), draw_screen_quad);
+    });
+    RGResource neighborMax = renderGraph.create("neighbor max", MotionBlurTiles::target_desc(sceneScale));
+    renderGraph.add_pass("neighbor max", {tileMax}, neighborMax, [tileMax] {
+        blurTiles.draw_neighbor_max(renderGraph.texture(tileMax), draw_screen_quad);
+    });
 
-    // Velocity texture
-    glGenTextures(1, &velocityTexture);
-    glBindTexture(GL_TEXTURE_2D, velocityTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, velocityTexture, 0);
+    RGResource tiles = motionBlurMode == MotionBlurMode::Reconstruction ? neighborMax : RG_NONE;
+    postDesc.scale = gHalfResPost ? POST_HALF_RES_SCALE : 1.0f;
+    RGResource blurred = renderGraph.create("motion blur", postDesc);
+    renderGraph.add_pass("motion blur", {scene, color, tiles}, blurred, [scene, color, tiles] {
+        motion_blur_pass(scene, color, tiles);
+    });
 
-    // Depth buffer
-    glGenRenderbuffers(1, &sceneDepthRBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, sceneDepthRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, w, h);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, sceneDepthRBO);
+    renderGraph.present(blurOn ? blurred : color);
+}
 
-    GLenum attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-    glDrawBuffers(2, attachments);
+static void shadow_pass() {
+    shadowTimer.begin();
+    ShadingMode prevShading = gRenderer.get_shading_mode();
+    shadowMap.update(cameraMatrix, projectionMatrix, dirLight.direction);
+    const ShadowCascades& cascades = shadowMap.get_cascades();
+    gRenderer.set_shading_mode(ShadingMode::DepthOnly);
+
+    // Static casters are only redrawn when the light or the static set changes.
+    if (gShadowCacheOn && shadowMap.static_layer_stale()) {
+        gRenderer.set_light_space_matrix(shadowMap.static_light_space());
+        shadowMap.begin_static_layer();
+        draw_static_shadow_casters();
+        shadowMap.end_static_update();
+        ++staticShadowRenders;
+    }
 
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "ERROR::FRAMEBUFFER:: Scene Framebuffer resize failed!" << std::endl;
+    for (int c = 0; c < cascades.count; ++c) {
+        gRenderer.set_light_space_matrix(cascades.lightSpace[c]);
+        shadowMap.begin_cascade(c, !gShadowCacheOn);
+        if (gShadowCacheOn)
+            shadowMap.resample_static_layer(c, draw_screen_quad);
+        else
+            draw_static_shadow_casters();
+        sceneRoot.draw_shadow_casters(ShadowCaster::Dynamic);
+        gRenderer.flush();
     }
+    gRenderer.set_shading_mode(prevShading);
+    gRenderer.set_shadow_cascades(cascades);
+    shadowTimer.end();
+    ++shadowFrames;
+}
+
+static void lighting_pass() {
+    sceneTimer.begin();
+    gRenderer.set_velocity_output(motionBlurMode != MotionBlurMode::Off || gTemporalOn);
+    gRenderer.set_projection_jitter(sceneJitterNdc);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    gRenderer.set_shadow_map(gShadowOn ? shadowMap.texture() : 0);
+
+    background::draw();
+    sceneRoot.draw();
+    gRenderer.flush();
+    draw_bounding_box();
+    gRenderer.set_projection_jitter(glm::vec2(0.0f));   // overlays drawn later stay put
+    sceneTimer.end();
+    // everything after the lighting pass, up to the end of the graph, counts as post
+    postTimer.begin();
+}
+
+// color is the scene or its temporally upsampled version; neighborMax is RG_NONE outside
+// reconstruction mode. Velocity and depth always come from the scene target.
+static void motion_blur_pass(RGResource scene, RGResource color, RGResource neighborMax) {
+    gRenderer.set_shading_mode(ShadingMode::MotionBlur);
+    gRenderer.set_motion_blur(motionBlurMode);
+    glDisable(GL_DEPTH_TEST);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, renderGraph.texture(color, 0));
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, renderGraph.texture(scene, 1));
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, renderGraph.depth_texture(scene));
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, renderGraph.texture(neighborMax));
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    draw_screen_quad();
+    // the depth texture is attached to the scene target; keep it off the units before the next scene pass
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glEnable(GL_DEPTH_TEST);
 }
 
 void draw_screen_quad() {
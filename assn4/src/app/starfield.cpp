@@ -0,0 +1,42 @@
+#include "starfield.h"
+
+#include <GL/glew.h>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "core/render/shader_program.h"
+
+namespace starfield {
+
+namespace {
+ShaderProgram program;
+GLuint emptyVAO = 0;   // core profile draws need a VAO even without attributes
+}
+
+bool init() {
+    if (!program.load_from_files("core/render/shaders/starfield.vert", "core/render/shaders/starfield.frag"))
+        return false;
+    if (!emptyVAO)
+        glGenVertexArrays(1, &emptyVAO);
+    return true;
+}
+
+void draw(const glm::mat4& viewProj, int count, uint32_t seed, float extent) {
+    if (!emptyVAO || count <= 0)
+        return;
+    program.bind();
+    glUniformMatrix4fv(program.uniform_location("uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+    glUniform1ui(program.uniform_location("uSeed"), seed);
+    glUniform1f(program.uniform_location("uExtent"), extent);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_POINTS, 0, count);
+    glBindVertexArray(0);
+    program.unbind();
+}
+
+void shutdown() {
+    if (emptyVAO)
+        glDeleteVertexArrays(1, &emptyVAO);
+    emptyVAO = 0;
+}
+
+} // namespace starfield
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace starfield {
+
+// Stars are generated in the vertex shader from gl_VertexID, so there is no vertex data:
+// the count costs GPU vertex work only, and a new seed gives a new sky for free.
+bool init();
+
+// One GL_POINTS draw of `count` stars inside a cube of half size `extent`.
+void draw(const glm::mat4& viewProj, int count, uint32_t seed, float extent);
+
+void shutdown();
+
+} // namespace starfield
@@ -0,0 +1,219 @@
+#include "core/base/alloc_tracker.h"
+
+#ifdef ALLOC_TRACKING
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int SITE_DEPTH = 4;        // return addresses kept per site, above operator new
+constexpr size_t SITE_SLOTS = 1024;  // open addressing; power of two
+
+struct Site {
+    void* frames[SITE_DEPTH];
+    int depth = 0;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// The table is static and written only by the thread that enabled recording (the main
+// thread); nothing in the hook may allocate.
+Site sites[SITE_SLOTS];
+size_t siteCount = 0;
+uint64_t droppedSites = 0;
+
+thread_local uint64_t tlsAllocations = 0;
+thread_local uint64_t tlsBytes = 0;
+thread_local bool tlsRecord = false;
+thread_local bool tlsForbidden = false;
+thread_local bool tlsInHook = false;   // backtrace() may allocate on first use
+
+// record_site, on_allocate, allocate and operator new; the helpers are kept out of line
+// so the count holds at any optimization level
+constexpr int SKIPPED_FRAMES = 4;
+
+[[gnu::noinline]] void record_site(size_t bytes) {
+    void* stack[SITE_DEPTH + SKIPPED_FRAMES];
+    int depth = backtrace(stack, SITE_DEPTH + SKIPPED_FRAMES) - SKIPPED_FRAMES;
+    if (depth <= 0)
+        return;
+
+    uintptr_t hash = 0;
+    for (int i = 0; i < depth; ++i)
+        hash = hash * 31 + reinterpret_cast<uintptr_t>(stack[SKIPPED_FRAMES + i]);
+    for (size_t probe = 0; probe < SITE_SLOTS; ++probe) {
+        Site& site = sites[(hash + probe) & (SITE_SLOTS - 1)];
+        if (site.depth == 0) {
+            if (siteCount == SITE_SLOTS / 2) {   // keep probes short
+                ++droppedSites;
+                return;
+            }
+            site.depth = depth;
+            std::memcpy(site.frames, stack + SKIPPED_FRAMES, sizeof(void*) * depth);
+            ++siteCount;
+        }
+        else if (site.depth != depth || std::memcmp(site.frames, stack + SKIPPED_FRAMES, sizeof(void*) * depth) != 0) {
+            continue;
+        }
+        ++site.allocations;
+        site.bytes += bytes;
+        return;
+    }
+}
+
+[[noreturn]] void report_forbidden(size_t bytes) {
+    char message[128];
+    std::snprintf(message, sizeof(message), "[AllocTracker] %zu byte allocation in an allocation-free zone:\n", bytes);
+    std::fputs(message, stderr);
+    void* stack[32];
+    int depth = backtrace(stack, 32);
+    backtrace_symbols_fd(stack, depth, 2);
+    std::abort();
+}
+
+[[gnu::noinline]] void on_allocate(size_t bytes) {
+    ++tlsAllocations;
+    tlsBytes += bytes;
+    if (tlsInHook || !(tlsRecord || tlsForbidden))
+        return;
+    tlsInHook = true;
+    if (tlsForbidden)
+        report_forbidden(bytes);
+    record_site(bytes);
+    tlsInHook = false;
+}
+
+[[gnu::noinline]] void* allocate(size_t bytes) {
+    on_allocate(bytes);
+    return std::malloc(bytes ? bytes : 1);
+}
+
+[[gnu::noinline]] void* allocate_aligned(size_t bytes, std::align_val_t alignment) {
+    on_allocate(bytes);
+    size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    return std::aligned_alloc(align, (std::max<size_t>(bytes, 1) + align - 1) / align * align);
+}
+
+// "./main(_ZN8Renderer5flushEv+0x1c) [0x...]" -> "Renderer::flush()+0x1c"
+std::string demangle(const char* symbol) {
+    std::string text = symbol;
+    size_t open = text.find('(');
+    size_t plus = text.find('+', open);
+    if (open == std::string::npos || plus == std::string::npos || plus == open + 1)
+        return text;
+    std::string mangled = text.substr(open + 1, plus - open - 1);
+    int status = 0;
+    char* name = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    if (status != 0)
+        return text;
+    std::string result = name + text.substr(plus, text.find(')', plus) - plus);
+    std::free(name);
+    return result;
+}
+}
+
+void* operator new(size_t bytes) {
+    if (void* p = allocate(bytes))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t bytes) {
+    if (void* p = allocate(bytes))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept { return allocate(bytes); }
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept { return allocate(bytes); }
+void* operator new(size_t bytes, std::align_val_t alignment) {
+    if (void* p = allocate_aligned(bytes, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t bytes, std::align_val_t alignment) {
+    if (void* p = allocate_aligned(bytes, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace alloc_tracker {
+
+bool enabled() { return true; }
+
+AllocCounts thread_counts() { return {tlsAllocations, tlsBytes}; }
+
+void set_record_sites(bool enabled) { tlsRecord = enabled; }
+
+bool set_forbidden(bool forbidden) {
+    bool previous = tlsForbidden;
+    tlsForbidden = forbidden;
+    return previous;
+}
+
+void print_top_sites(std::ostream& out, int count) {
+    bool wasRecording = tlsRecord;
+    tlsRecord = false;   // the sort and symbolization below allocate
+
+    std::vector<const Site*> used;
+    for (const Site& site : sites)
+        if (site.depth > 0)
+            used.push_back(&site);
+    std::sort(used.begin(), used.end(), [](const Site* a, const Site* b) { return a->allocations > b->allocations; });
+    if (used.empty())
+        out << "[AllocTracker] no allocations recorded inside zones\n";
+    for (int i = 0; i < count && i < static_cast<int>(used.size()); ++i) {
+        const Site& site = *used[i];
+        out << "[AllocTracker] " << site.allocations << " allocations, " << site.bytes << " bytes\n";
+        char** symbols = backtrace_symbols(site.frames, site.depth);
+        for (int f = 0; f < site.depth; ++f)
+            out << "    " << (symbols ? demangle(symbols[f]) : std::string("?")) << '\n';
+        std::free(symbols);
+    }
+    if (droppedSites)
+        out << "[AllocTracker] " << droppedSites << " allocations at sites beyond the table\n";
+
+    tlsRecord = wasRecording;
+}
+
+void reset_sites() {
+    for (Site& site : sites)
+        site = Site{};
+    siteCount = 0;
+    droppedSites = 0;
+}
+
+}
+
+#else   // ALLOC_TRACKING
+
+namespace alloc_tracker {
+
+bool enabled() { return false; }
+AllocCounts thread_counts() { return {}; }
+void set_record_sites(bool) {}
+bool set_forbidden(bool) { return false; }
+void print_top_sites(std::ostream& out, int) {
+    out << "[AllocTracker] not compiled in (make clean && make ALLOC_TRACKING=1)\n";
+}
+void reset_sites() {}
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Heap allocation tracking through a global operator new/delete replacement, compiled in
+// only with `make ALLOC_TRACKING=1` (after `make clean`). Without it every query below
+// reports zero and enabled() is false.
+namespace alloc_tracker {
+
+struct AllocCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+bool enabled();
+
+// operator new calls made by the calling thread so far
+AllocCounts thread_counts();
+
+// While set, the calling thread's allocations are tallied per call site (a few return
+// addresses deep), for print_top_sites().
+void set_record_sites(bool enabled);
+// While set, an allocation on the calling thread prints its stack to stderr and aborts.
+// Returns the previous value, for nesting.
+bool set_forbidden(bool forbidden);
+
+// Most frequent recorded sites, symbolized; link with -rdynamic for function names.
+void print_top_sites(std::ostream& out, int count);
+void reset_sites();
+
+}
@@ -0,0 +1,66 @@
+#include "core/base/frame_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+FrameArena::~FrameArena() {
+    for (auto& half : halves)
+        for (void* block : half.overflow)
+            ::operator delete(block);
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    Half& half = halves[current];
+    if (!half.memory) {
+        half.capacity = std::max(half.capacity, DEFAULT_CAPACITY);
+        half.memory.reset(new unsigned char[half.capacity]);
+        half.overflow.reserve(16);
+    }
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(half.memory.get());
+    uintptr_t aligned = (base + half.used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    size_t end = static_cast<size_t>(aligned - base) + bytes;
+    if (end <= half.capacity) {
+        half.used = end;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Out of room: the heap covers this frame, reset() grows the half for the next time round
+    void* block = ::operator new(bytes);   // max_align_t aligned, the most allocate() is asked for
+    half.overflow.push_back(block);
+    half.overflowBytes += bytes + alignment;
+    return block;
+}
+
+void FrameArena::begin_frame() {
+    const Half& finished = halves[current];
+    lastUsed = finished.used + finished.overflowBytes;
+    lastFallbacks = finished.overflow.size();
+    peakUsed = std::max(peakUsed, lastUsed);
+
+    current = 1 - current;
+    reset(halves[current]);
+}
+
+// The half last used two frames ago: nothing may point into it any more.
+void FrameArena::reset(Half& half) {
+    if (poison && half.memory)
+        std::memset(half.memory.get(), POISON, half.used);
+    for (void* block : half.overflow)
+        ::operator delete(block);
+    half.overflow.clear();
+
+    if (half.overflowBytes > 0) {
+        size_t needed = half.used + half.overflowBytes;
+        size_t grown = std::max(half.capacity, DEFAULT_CAPACITY);
+        while (grown < needed)
+            grown *= 2;
+        half.memory.reset(new unsigned char[grown]);
+        half.capacity = grown;
+        std::cout << "[FrameArena] Grew a frame to " << grown / 1024 << " KB" << std::endl;
+    }
+    half.used = 0;
+    half.overflowBytes = 0;
+}
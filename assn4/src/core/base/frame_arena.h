@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for data that lives no longer than the next frame (light lists, pass
+// declarations, scratch arrays). Two halves alternate: begin_frame() switches to the
+// other half and releases it wholesale, so anything allocated during frame N stays
+// valid through frame N + 1. Main thread only.
+//
+// A frame that outgrows its half falls back to the heap and the half is enlarged to fit
+// when it is next released, so a steady frame stops allocating after the first few.
+// With poisoning on, released memory is overwritten with 0xDD to expose stale pointers.
+class FrameArena {
+private:
+    static constexpr size_t DEFAULT_CAPACITY = 256 * 1024;   // per half
+    static constexpr unsigned char POISON = 0xDD;
+
+    struct Half {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t capacity = 0;
+        size_t used = 0;
+        std::vector<void*> overflow;   // heap fallbacks, freed with the half
+        size_t overflowBytes = 0;
+    };
+
+    std::array<Half, 2> halves;
+    int current = 0;
+    bool poison = false;
+    size_t lastUsed = 0;             // bytes of the previous frame, fallbacks included
+    size_t lastFallbacks = 0;
+    size_t peakUsed = 0;
+
+    void reset(Half& half);
+
+public:
+    FrameArena() = default;
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // alignment: a power of two, at most alignof(std::max_align_t)
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    void begin_frame();
+
+    void set_poison(bool enabled) { poison = enabled; }
+    bool poisoning() const { return poison; }
+
+    size_t capacity() const { return halves[current].capacity; }
+    size_t last_frame_bytes() const { return lastUsed; }
+    size_t peak_bytes() const { return peakUsed; }
+    // Heap fallbacks of the previous frame; 0 once the halves have grown to fit
+    size_t last_frame_fallbacks() const { return lastFallbacks; }
+};
+
+inline FrameArena gFrameArena;
+
+// STL adapter: containers allocate from gFrameArena and never free individually.
+// Reserve up front where the size is known, since growth abandons the old block.
+template <typename T>
+struct FrameAllocator {
+    using value_type = T;
+
+    FrameAllocator() = default;
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(gFrameArena.allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) { return false; }
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -1,45 +1,67 @@
 #include "core/base/object.h"
 #include "core/globals/camera.h"
+#include "core/render/renderer.h"
 #include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+static_assert(sizeof(Object) <= 104, "Object's hot fields grew; put rarely used fields in ObjectCold");
+
+uint32_t ObjectColdTable::acquire() {
+    if (freeRecords.empty()) {
+        if (records.size() == MAX_RECORDS) {
+            std::cerr << "[Object] More than " << MAX_RECORDS << " live objects" << std::endl;
+            std::abort();
+        }
+        records.emplace_back();
+        return static_cast<uint32_t>(records.size() - 1);
+    }
+    uint32_t index = freeRecords.back();
+    freeRecords.pop_back();
+    return index;
+}
+
+void ObjectColdTable::release(uint32_t index) {
+    records[index] = ObjectCold{};
+    freeRecords.push_back(index);
+}
 
 Object::Object(glm::vec3 _pos, GLfloat _angle, glm::vec3 _axis, glm::vec3 _size, glm::vec3 _center)
-: modelMatrix(glm::mat4(1.0f)), 
-  prevModelMatrix(glm::mat4(1.0f)),
-  center(_center),
-  parent(nullptr),
-  isLocal(true) {
+: coldIndex(gObjectCold.acquire()),
+  isLocal(true),
+  isActive(true),
+  isVisible(true),
+  hasChildren(false),
+  shadowCaster(static_cast<uint32_t>(ShadowCaster::Dynamic)) {
+    cold().center = _center;
     init(_pos, _angle, _axis, _size, _center);
 }
 
 Object::~Object() {
     clear_children();
     detach_from_parent();
+    gObjectCold.release(coldIndex);
+}
+
+Transform Object::world_transform() const {
+    return parent ? parent->world_transform() * transform : transform;
 }
 
 glm::vec3 Object::get_pos() const {
-    return glm::vec3(get_finalMatrix()[3]);
+    return parent ? parent->world_transform().transform_point(transform.translation) : transform.translation;
 }
 
 glm::vec3 Object::get_size() const {
-    glm::mat3 rotationMatrix = glm::mat3(get_finalMatrix());
-    GLfloat scaleX = glm::length(rotationMatrix[0]);
-    GLfloat scaleY = glm::length(rotationMatrix[1]);
-    GLfloat scaleZ = glm::length(rotationMatrix[2]);
-    return glm::vec3(scaleX, scaleY, scaleZ);
+    return world_transform().scale;
 }
 
 glm::quat Object::get_quat() const {
-    // extract only a direction of modelMatrix
-    glm::mat3 rotationMatrix = glm::mat3(get_finalMatrix());
-    rotationMatrix[0] = glm::normalize(rotationMatrix[0]);
-    rotationMatrix[1] = glm::normalize(rotationMatrix[1]);
-    rotationMatrix[2] = glm::normalize(rotationMatrix[2]);
-
-    return glm::quat_cast(rotationMatrix);
+    return world_transform().rotation;
 }
 
 glm::mat4 Object::get_finalMatrix() const {
-    return parent ? parent->get_finalMatrix() * modelMatrix : modelMatrix;
+    return parent ? parent->get_finalMatrix() * get_modelMatrix() : get_modelMatrix();
 }
 
 void Object::set_parent(Object* _parent, bool fix) {
@@ -53,18 +75,17 @@ void Object::set_parent(Object* _parent, bool fix) {
 
     if (parent) {
         if (fix)
-            modelMatrix = glm::inverse(parent->get_finalMatrix()) * modelMatrix;
+            set_modelMatrix(glm::inverse(parent->get_finalMatrix()) * get_modelMatrix());
         isLocal = false;
         parent->add_child_reference(this);
     }
     else {
-        modelMatrix = get_finalMatrix();
         isLocal = true;
     }
 }
 
 void Object::init(glm::vec3 _pos, GLfloat _angle, glm::vec3 _axis, glm::vec3 _size, glm::vec3 /*_center*/) {
-    modelMatrix = glm::mat4(1.0f);
+    set_transform(Transform{});
     translate_world(_pos);
     rotate_local(_angle, _axis);
     scale_local(_size);
@@ -91,35 +112,46 @@ void Object::scale(glm::vec3 v) {
         scale_world(v);
 }
 
+// The operations below keep the results of the former matrix products (M * X for local,
+// X * M for world, M = T * R * S) in TRS form. A local rotation about the pivot is exact
+// while the object's scale is uniform in the rotation plane, as it is for every caller.
+
 void Object::translate_local(glm::vec3 v) {
-    modelMatrix = glm::translate(modelMatrix, v);
+    transform.translation += transform.rotation * (transform.scale * v);
 }
 
+// M * T(c) * R' * T(-c)
 void Object::rotate_local(GLfloat angle, glm::vec3 axis) {
-    translate_local(center);
-    modelMatrix = glm::rotate(modelMatrix, glm::radians(angle), axis);
-    translate_local(-center);
+    glm::vec3 pivot = transform.scale * cold().center;
+    glm::quat rotation = glm::normalize(transform.rotation * glm::angleAxis(glm::radians(angle), glm::normalize(axis)));
+    transform.translation += transform.rotation * pivot - rotation * pivot;
+    transform.rotation = rotation;
 }
 
+// M * T(c) * S' * T(-c) for local objects; plain M * S' otherwise, as translate() moved
+// the pivot in world space and back.
 void Object::scale_local(glm::vec3 v) {
-    translate(center);
-    modelMatrix = glm::scale(modelMatrix, v);
-    translate(-center);
+    if (isLocal) {
+        glm::vec3 center = cold().center;
+        transform.translation += transform.rotation * (transform.scale * center - transform.scale * v * center);
+    }
+    transform.scale *= v;
 }
 
 void Object::translate_world(glm::vec3 v) {
-    glm::mat4 mT = glm::translate(glm::mat4(1.0f), v);
-    modelMatrix = mT * modelMatrix;
+    transform.translation += v;
 }
 
 void Object::rotate_world(GLfloat angle, glm::vec3 axis) {
-    glm::mat4 mR = glm::rotate(glm::mat4(1.0f), glm::radians(angle), axis);
-    modelMatrix = mR * modelMatrix;
+    glm::quat rotation = glm::angleAxis(glm::radians(angle), glm::normalize(axis));
+    transform.translation = rotation * transform.translation;
+    transform.rotation = glm::normalize(rotation * transform.rotation);
 }
 
+// Exact for a uniform v; a non-uniform world scale of a rotated object would shear.
 void Object::scale_world(glm::vec3 v) {
-    glm::mat4 mS = glm::scale(glm::mat4(1.0f), v);
-    modelMatrix = mS * modelMatrix;
+    transform.translation *= v;
+    transform.scale *= v;
 }
 
 void Object::update(float deltaTime) { 
@@ -128,11 +160,13 @@ void Object::update(float deltaTime) {
     
     // 부모의 직전 월드 행렬을 사용해 내 직전 월드 행렬을 기록해야 모션 벡터가 올바르게 계산된다.
     if (parent && isLocal)
-        prevModelMatrix = parent->get_prevModelMatrix() * modelMatrix;
+        prevWorld = parent->prevWorld * transform;
     else
-        prevModelMatrix = get_finalMatrix();
+        prevWorld = world_transform();
     update_logic(deltaTime);
-    for (auto child : children) 
+    if (!hasChildren)
+        return;
+    for (auto child : cold().children) 
         if (child) child->update(deltaTime); 
 };
 
@@ -141,19 +175,37 @@ void Object::draw() const {
         return;
 
     draw_shape();
-    for (auto child : children)
+    if (!hasChildren)
+        return;
+    for (auto child : cold().children)
         if (child)
             child->draw();
 }
 
+void Object::draw_shadow_casters(ShadowCaster kind) const {
+    if (!isActive || !isVisible)
+        return;
+
+    if (get_shadowCaster() == kind) {
+        if (const auto& mesh = cold().mesh)
+            gRenderer.submit_shadow(*mesh, shape_matrix());
+    }
+    if (!hasChildren)
+        return;
+    for (auto child : cold().children)
+        if (child)
+            child->draw_shadow_casters(kind);
+}
+
 bool Object::check_collision(Object* other) {
     float distance = glm::distance(get_pos(), other->get_pos());
     return distance <= get_hitboxRadius() + other->get_hitboxRadius(); 
 }
 
 void Object::clear_children() {
-    std::vector<Object*> temp = children;
-    children.clear();
+    std::vector<Object*> temp = std::move(cold().children);
+    cold().children.clear();
+    hasChildren = false;
     for (auto* child : temp)
         if (child)
             child->set_parent(nullptr);
@@ -170,14 +222,18 @@ void Object::detach_from_parent() {
 void Object::add_child_reference(Object* child) {
     if (!child)
         return;
+    std::vector<Object*>& children = cold().children;
     if (std::find(children.begin(), children.end(), child) == children.end())
         children.push_back(child);
+    hasChildren = true;
 }
 
 void Object::remove_child_reference(Object* child) {
     if (!child)
         return;
+    std::vector<Object*>& children = cold().children;
     auto it = std::remove(children.begin(), children.end(), child);
     if (it != children.end())
         children.erase(it, children.end());
+    hasChildren = !children.empty();
 }
@@ -0,0 +1,112 @@
+#include "core/base/profiler.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+alloc_tracker::AllocCounts operator-(const alloc_tracker::AllocCounts& a, const alloc_tracker::AllocCounts& b) {
+    return {a.allocations - b.allocations, a.bytes - b.bytes};
+}
+
+void operator+=(alloc_tracker::AllocCounts& a, const alloc_tracker::AllocCounts& b) {
+    a.allocations += b.allocations;
+    a.bytes += b.bytes;
+}
+}
+
+// Callers pass string literals, so the pointer usually matches; strcmp covers the rest.
+int Profiler::find_zone(const char* name, bool allocFree) {
+    for (size_t i = 0; i < zones.size(); ++i)
+        if (zones[i].name == name || std::strcmp(zones[i].name, name) == 0)
+            return static_cast<int>(i);
+    Zone zone;
+    zone.name = name;
+    zone.allocFree = allocFree;
+    zones.push_back(zone);
+    return static_cast<int>(zones.size() - 1);
+}
+
+void Profiler::enter(const char* name, bool allocFree) {
+    if (depth == MAX_DEPTH) {
+        ++depth;   // still balanced by leave(), just not measured
+        return;
+    }
+    OpenZone& entry = open[depth++];
+    entry.zone = find_zone(name, allocFree);
+    entry.recording = warmed_up();
+    entry.forbidding = entry.recording && assertAllocFree && allocFree;
+    if (entry.recording)
+        alloc_tracker::set_record_sites(true);
+    if (entry.forbidding)
+        entry.wasForbidden = alloc_tracker::set_forbidden(true);
+    entry.counts = alloc_tracker::thread_counts();
+    entry.start = Clock::now();
+}
+
+void Profiler::leave() {
+    if (depth == 0)
+        return;
+    if (depth-- > MAX_DEPTH)
+        return;
+    const OpenZone& entry = open[depth];
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - entry.start).count();
+    alloc_tracker::AllocCounts counts = alloc_tracker::thread_counts() - entry.counts;
+    if (entry.forbidding)
+        alloc_tracker::set_forbidden(entry.wasForbidden);
+    if (entry.recording && depth == 0)
+        alloc_tracker::set_record_sites(false);
+
+    Zone& zone = zones[entry.zone];
+    zone.frameMs += ms;
+    zone.frameAllocs += counts;
+    zone.totalMs += ms;
+    zone.totalAllocs += counts;
+    ++zone.calls;
+}
+
+void Profiler::begin_frame() {
+    for (auto& zone : zones) {
+        zone.lastMs = zone.frameMs;
+        zone.lastAllocs = zone.frameAllocs;
+        zone.frameMs = 0.0;
+        zone.frameAllocs = {};
+    }
+    ++frames;
+    if (frames == warmupEnd && assertAllocFree)
+        std::cout << "[Profiler] warm-up over, allocation-free zones are now checked" << std::endl;
+}
+
+void Profiler::print(std::ostream& out, int topSites) const {
+    bool counting = alloc_tracker::enabled();
+    std::ios::fmtflags flags = out.flags();   // restored below; out is usually std::cout
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "[Profiler] " << frames << " frames" << (warmed_up() ? "" : " (warming up)")
+        << (counting ? "" : ", allocations not tracked") << '\n';
+    for (const auto& zone : zones) {
+        double averageMs = frames ? zone.totalMs / static_cast<double>(frames) : 0.0;
+        out << "[Profiler] " << std::left << std::setw(16) << zone.name << std::right
+            << " last " << std::setw(8) << zone.lastMs << " ms, avg " << std::setw(8) << averageMs << " ms";
+        if (counting)
+            out << ", last frame " << zone.lastAllocs.allocations << " allocs / " << zone.lastAllocs.bytes
+                << " B, total " << zone.totalAllocs.allocations;
+        out << (zone.allocFree ? "  [alloc-free]" : "") << '\n';
+    }
+    out.flags(flags);
+    out.precision(precision);
+    if (counting)
+        alloc_tracker::print_top_sites(out, topSites);
+}
+
+bool Profiler::export_report(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "[Profiler] Cannot write " << path << std::endl;
+        return false;
+    }
+    print(file, 20);
+    std::cout << "[Profiler] Report written to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "core/base/alloc_tracker.h"
+
+// CPU profiler: wall time and heap allocations (with ALLOC_TRACKING) per named zone,
+// kept for the last complete frame and accumulated since start. Zones nest; a zone's
+// numbers include its children. Main thread only.
+//
+// Zones opened with ZONE_ALLOC_FREE must not allocate once warm-up is over: with the
+// assertion on, an allocation there prints its stack and aborts. Warm-up restarts on
+// restart_warmup(), for state changes that legitimately allocate. Zones register on
+// first entry, which allocates, so every zone should be reached during warm-up.
+constexpr bool ZONE_ALLOC_FREE = true;
+
+class Profiler {
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int MAX_DEPTH = 16;
+
+    struct Zone {
+        const char* name = "";
+        bool allocFree = false;
+        double frameMs = 0.0;                   // this frame so far
+        alloc_tracker::AllocCounts frameAllocs;
+        double lastMs = 0.0;                    // last complete frame
+        alloc_tracker::AllocCounts lastAllocs;
+        double totalMs = 0.0;
+        alloc_tracker::AllocCounts totalAllocs;
+        uint64_t calls = 0;
+    };
+    struct OpenZone {
+        int zone = -1;
+        Clock::time_point start;
+        alloc_tracker::AllocCounts counts;
+        bool recording = false;
+        bool forbidding = false;
+        bool wasForbidden = false;
+    };
+
+    std::vector<Zone> zones;   // grows only while new zones first appear
+    std::array<OpenZone, MAX_DEPTH> open{};
+    int depth = 0;
+    uint64_t frames = 0;
+    uint64_t warmupEnd = 0;    // first frame past warm-up
+    int warmupFrames = 120;
+    bool assertAllocFree = false;
+
+    int find_zone(const char* name, bool allocFree);
+    bool warmed_up() const { return frames >= warmupEnd; }
+
+public:
+    void enter(const char* name, bool allocFree = false);
+    void leave();
+
+    // Rolls this frame's numbers into the last-frame columns.
+    void begin_frame();
+    void restart_warmup() { warmupEnd = frames + warmupFrames; }
+    void set_warmup_frames(int count) { warmupFrames = count; restart_warmup(); }
+    void set_assert_alloc_free(bool enabled) { assertAllocFree = enabled; }
+    bool asserting_alloc_free() const { return assertAllocFree; }
+
+    // Zone table, then the top allocation call sites recorded inside zones after warm-up.
+    void print(std::ostream& out, int topSites = 5) const;
+    bool export_report(const std::string& path) const;
+};
+
+inline Profiler gProfiler;
+
+// Opens a zone for the enclosing scope.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name, bool allocFree = false) { gProfiler.enter(name, allocFree); }
+    ~ProfileScope() { gProfiler.leave(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Translation / rotation / scale, composed as T * R * S. Rotations are kept as a unit
+// quaternion renormalized after every change, so thousands of small incremental rotations
+// stay a pure rotation instead of drifting into scale and shear the way a repeatedly
+// multiplied matrix does.
+struct Transform {
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    glm::mat4 matrix() const {
+        glm::mat3 r = glm::mat3_cast(rotation);
+        glm::mat4 m(1.0f);
+        m[0] = glm::vec4(r[0] * scale.x, 0.0f);
+        m[1] = glm::vec4(r[1] * scale.y, 0.0f);
+        m[2] = glm::vec4(r[2] * scale.z, 0.0f);
+        m[3] = glm::vec4(translation, 1.0f);
+        return m;
+    }
+
+    glm::vec3 transform_point(glm::vec3 p) const { return translation + rotation * (scale * p); }
+
+    // parent * child. Exact for the translation; the rotation and scale are exact while
+    // the parent's scale is uniform (a non-uniform parent scale under a rotated child is
+    // a shear, which TRS cannot hold).
+    Transform operator*(const Transform& child) const {
+        return {transform_point(child.translation), glm::normalize(rotation * child.rotation), scale * child.scale};
+    }
+
+    // Decomposes an affine matrix; shear is dropped, a mirror goes into scale.x.
+    static Transform from_matrix(const glm::mat4& m) {
+        Transform t;
+        t.translation = glm::vec3(m[3]);
+        glm::mat3 r(m);
+        t.scale = glm::vec3(glm::length(r[0]), glm::length(r[1]), glm::length(r[2]));
+        if (glm::determinant(r) < 0.0f)
+            t.scale.x = -t.scale.x;
+        r[0] /= t.scale.x;
+        r[1] /= t.scale.y;
+        r[2] /= t.scale.z;
+        t.rotation = glm::normalize(glm::quat_cast(r));
+        return t;
+    }
+};
@@ -0,0 +1,295 @@
+#include "core/render/asset_registry.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include "core/render/mesh.h"
+
+namespace {
+constexpr size_t STREAM_BYTES_PER_FRAME = 4u * 1024u * 1024u;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+const Texture2D nullTexture;
+}
+
+MeshHandle AssetRegistry::mesh_handle(const std::string& path) {
+    if (auto it = meshLookup.find(path); it != meshLookup.end())
+        return {it->second};
+
+    uint32_t index = static_cast<uint32_t>(meshes.size());
+    meshes.push_back({});
+    meshes.back().path = path;
+    meshLookup.emplace(path, index);
+    return {index};
+}
+
+TextureHandle AssetRegistry::texture_handle(const std::string& path) {
+    if (auto it = textureLookup.find(path); it != textureLookup.end())
+        return {it->second};
+
+    uint32_t index = static_cast<uint32_t>(textures.size());
+    textures.push_back({});
+    textures.back().path = path;
+    textureLookup.emplace(path, index);
+    return {index};
+}
+
+bool AssetRegistry::load(MeshSlot& slot) {
+    auto start = Clock::now();
+    auto mesh = std::make_shared<Mesh>();
+    if (!mesh->load_from_obj(slot.path)) {
+        std::cerr << "[Assets] Failed to load mesh " << slot.path << '\n';
+        slot.failed = true;
+        return false;
+    }
+
+    slot.mesh = std::move(mesh);
+    slot.stats.loadMs = elapsed_ms(start);
+    slot.stats.totalLoadMs += slot.stats.loadMs;
+    slot.stats.bytes = slot.mesh->byte_size();
+    slot.stats.loadCount++;
+    residentBytes += slot.stats.bytes;
+    enforce_budget();
+    return true;
+}
+
+bool AssetRegistry::load(TextureSlot& slot) {
+    auto start = Clock::now();
+    // decode_texture prefers the offline-cooked container (compressed, prebuilt mips).
+    CookedTexture data;
+    Texture2D tex = decode_texture(slot.path, data) ? create_texture(data) : Texture2D{};
+    if (tex.id == 0) {
+        std::cerr << "[Assets] Failed to load texture " << slot.path << '\n';
+        slot.failed = true;
+        return false;
+    }
+
+    install(slot, {0, tex, elapsed_ms(start)});
+    return true;
+}
+
+void AssetRegistry::install(TextureSlot& slot, const StreamedTexture& result) {
+    slot.streaming = false;
+    if (result.texture.id == 0) {
+        slot.failed = true;
+        return;
+    }
+
+    slot.texture = result.texture;
+    slot.stats.loadMs = result.uploadMs;
+    slot.stats.totalLoadMs += slot.stats.loadMs;
+    slot.stats.bytes = result.texture.bytes;
+    slot.stats.loadCount++;
+    residentBytes += slot.stats.bytes;
+    enforce_budget();
+}
+
+void AssetRegistry::release(MeshSlot& slot) {
+    if (!slot.mesh)
+        return;
+    slot.mesh.reset();
+    residentBytes -= slot.stats.bytes;
+    slot.stats.bytes = 0;
+    slot.stats.evictCount++;
+}
+
+void AssetRegistry::release(TextureSlot& slot) {
+    if (!slot.texture.id)
+        return;
+    glDeleteTextures(1, &slot.texture.id);
+    slot.texture = {};
+    residentBytes -= slot.stats.bytes;
+    slot.stats.bytes = 0;
+    slot.stats.evictCount++;
+}
+
+bool AssetRegistry::evictable(const MeshSlot& slot) const {
+    // use_count() == 1 means the registry holds the only reference
+    return slot.mesh && !slot.pinned && slot.mesh.use_count() == 1;
+}
+
+bool AssetRegistry::evictable(const TextureSlot& slot) const {
+    return slot.texture.id && !slot.pinned;
+}
+
+void AssetRegistry::enforce_budget() {
+    if (budgetBytes == 0)
+        return;
+
+    while (residentBytes > budgetBytes) {
+        // Evict the least recently used candidate; never the one touched this frame.
+        MeshSlot* lruMesh = nullptr;
+        TextureSlot* lruTexture = nullptr;
+        uint64_t oldest = frame;
+        for (auto& slot : meshes) {
+            if (evictable(slot) && slot.lastUsedFrame < oldest) {
+                oldest = slot.lastUsedFrame;
+                lruMesh = &slot;
+            }
+        }
+        for (auto& slot : textures) {
+            if (evictable(slot) && slot.lastUsedFrame < oldest) {
+                oldest = slot.lastUsedFrame;
+                lruTexture = &slot;
+                lruMesh = nullptr;
+            }
+        }
+
+        if (lruTexture)
+            release(*lruTexture);
+        else if (lruMesh)
+            release(*lruMesh);
+        else
+            break; // everything left is pinned, referenced or in use this frame
+    }
+}
+
+std::shared_ptr<Mesh> AssetRegistry::mesh(MeshHandle handle) {
+    if (!handle.valid())
+        return nullptr;
+
+    MeshSlot& slot = meshes[handle.index];
+    slot.lastUsedFrame = frame;
+    if (!slot.mesh && !slot.failed)
+        load(slot);
+    return slot.mesh;
+}
+
+GLuint AssetRegistry::texture(TextureHandle handle) {
+    return texture_info(handle).id;
+}
+
+Texture2D AssetRegistry::texture_info(TextureHandle handle) {
+    if (!handle.valid())
+        return nullTexture;
+
+    TextureSlot& slot = textures[handle.index];
+    slot.lastUsedFrame = frame;
+    if (!slot.texture.id && !slot.failed) {
+        if (slot.streaming)
+            install(slot, streamer.finish(handle.index)); // not prefetched early enough: stall
+        else
+            load(slot);
+    }
+    return slot.failed ? nullTexture : slot.texture;
+}
+
+bool AssetRegistry::preload(MeshHandle handle) {
+    return mesh(handle) != nullptr;
+}
+
+bool AssetRegistry::preload(TextureHandle handle) {
+    return texture(handle) != 0;
+}
+
+void AssetRegistry::prefetch(TextureHandle handle) {
+    if (!handle.valid())
+        return;
+    TextureSlot& slot = textures[handle.index];
+    if (slot.texture.id || slot.streaming || slot.failed)
+        return;
+    slot.streaming = true;
+    slot.lastUsedFrame = frame; // keep the budget from evicting it right after arrival
+    streamer.request(handle.index, slot.path);
+}
+
+bool AssetRegistry::resident(TextureHandle handle) const {
+    return handle.valid() && textures[handle.index].texture.id != 0;
+}
+
+int AssetRegistry::retry_failed() {
+    int count = 0;
+    for (auto& slot : meshes) {
+        count += slot.failed;
+        slot.failed = false;
+    }
+    for (auto& slot : textures) {
+        count += slot.failed;
+        slot.failed = false;
+    }
+    return count;
+}
+
+void AssetRegistry::begin_frame() {
+    ++frame;
+    streamed.clear();
+    streamer.pump(STREAM_BYTES_PER_FRAME, streamed);
+    for (const auto& result : streamed) {
+        TextureSlot& slot = textures[result.id];
+        if (result.texture.id == 0)
+            std::cerr << "[Assets] Failed to stream texture " << slot.path << '\n';
+        install(slot, result);
+    }
+}
+
+void AssetRegistry::pin(MeshHandle handle, bool pinned) {
+    if (handle.valid())
+        meshes[handle.index].pinned = pinned;
+}
+
+void AssetRegistry::pin(TextureHandle handle, bool pinned) {
+    if (handle.valid())
+        textures[handle.index].pinned = pinned;
+}
+
+bool AssetRegistry::evict(MeshHandle handle) {
+    if (!handle.valid() || !evictable(meshes[handle.index]))
+        return false;
+    release(meshes[handle.index]);
+    return true;
+}
+
+bool AssetRegistry::evict(TextureHandle handle) {
+    if (!handle.valid() || !evictable(textures[handle.index]))
+        return false;
+    release(textures[handle.index]);
+    return true;
+}
+
+void AssetRegistry::evict_unused() {
+    for (auto& slot : meshes)
+        if (evictable(slot))
+            release(slot);
+    for (auto& slot : textures)
+        if (evictable(slot) && slot.lastUsedFrame < frame)
+            release(slot);
+}
+
+void AssetRegistry::set_budget(size_t bytes) {
+    budgetBytes = bytes;
+    enforce_budget();
+}
+
+void AssetRegistry::print_stats() const {
+    auto print_row = [](const char* kind, const std::string& path, bool pinned, const AssetStats& s) {
+        std::cout << "  " << kind << (pinned ? " [pinned] " : "          ")
+                  << std::left << std::setw(42) << path << std::right
+                  << std::setw(10) << s.bytes << " B"
+                  << std::setw(9) << std::fixed << std::setprecision(2) << s.totalLoadMs << " ms"
+                  << "  loads " << s.loadCount << ", evictions " << s.evictCount << '\n';
+    };
+
+    std::cout << "[Assets] resident " << residentBytes << " B";
+    if (budgetBytes)
+        std::cout << " / budget " << budgetBytes << " B";
+    std::cout << '\n';
+    for (const auto& slot : meshes)
+        print_row("mesh   ", slot.path, slot.pinned, slot.stats);
+    for (const auto& slot : textures)
+        print_row("texture", slot.path, slot.pinned, slot.stats);
+}
+
+void AssetRegistry::shutdown() {
+    streamer.shutdown();
+    for (auto& slot : textures)
+        release(slot);
+    for (auto& slot : meshes)
+        release(slot);
+    residentBytes = 0;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "core/render/mesh_buffer.h"   // defined first, so gMeshBuffer outlives the meshes in gAssets
+#include "core/render/texture.h"
+#include "core/render/texture_streamer.h"
+
+class Mesh;
+
+// Stable integer handles into the registry slot tables (resolved in O(1)).
+// A slot is never removed, so a handle stays valid even after its data is evicted.
+constexpr uint32_t INVALID_ASSET = 0xFFFFFFFFu;
+
+struct MeshHandle {
+    uint32_t index = INVALID_ASSET;
+    bool valid() const { return index != INVALID_ASSET; }
+};
+
+struct TextureHandle {
+    uint32_t index = INVALID_ASSET;
+    bool valid() const { return index != INVALID_ASSET; }
+};
+
+struct AssetStats {
+    double loadMs = 0.0;   // duration of the most recent load
+    double totalLoadMs = 0.0;
+    size_t bytes = 0;      // resident CPU + GPU bytes (0 when evicted)
+    int loadCount = 0;
+    int evictCount = 0;
+};
+
+class AssetRegistry {
+private:
+    struct MeshSlot {
+        std::string path;
+        std::shared_ptr<Mesh> mesh;
+        bool pinned = false;
+        bool failed = false;      // last load failed; not retried until retry_failed()
+        uint64_t lastUsedFrame = 0;
+        AssetStats stats;
+    };
+
+    struct TextureSlot {
+        std::string path;
+        Texture2D texture;
+        bool pinned = false;
+        bool streaming = false;   // decode/upload requested via prefetch()
+        bool failed = false;      // last load failed; not retried until retry_failed()
+        uint64_t lastUsedFrame = 0;
+        AssetStats stats;
+    };
+
+    std::vector<MeshSlot> meshes;
+    std::vector<TextureSlot> textures;
+    std::unordered_map<std::string, uint32_t> meshLookup;    // path -> slot (only hashed on registration)
+    std::unordered_map<std::string, uint32_t> textureLookup;
+
+    size_t budgetBytes = 0;   // 0 = unlimited
+    size_t residentBytes = 0;
+    uint64_t frame = 0;
+
+    TextureStreamer streamer;
+    std::vector<StreamedTexture> streamed;   // reused by begin_frame()
+
+    bool load(MeshSlot& slot);
+    bool load(TextureSlot& slot);
+    void install(TextureSlot& slot, const StreamedTexture& result);
+    void release(MeshSlot& slot);
+    void release(TextureSlot& slot);
+    bool evictable(const MeshSlot& slot) const;
+    bool evictable(const TextureSlot& slot) const;
+    void enforce_budget();
+
+public:
+    // Registration only hashes the path; data is loaded on preload() or first resolve.
+    MeshHandle mesh_handle(const std::string& path);
+    TextureHandle texture_handle(const std::string& path);
+
+    // Resolve a handle, loading it again if it was evicted. Returns null/0 on failure.
+    // Results are copies: registering another asset may move the slot tables.
+    std::shared_ptr<Mesh> mesh(MeshHandle handle);
+    GLuint texture(TextureHandle handle);
+    Texture2D texture_info(TextureHandle handle);
+
+    bool preload(MeshHandle handle);
+    bool preload(TextureHandle handle);
+
+    // Decode on the streaming thread and upload during begin_frame() without stalling.
+    // Resolving the handle before it arrives falls back to finishing it synchronously.
+    void prefetch(TextureHandle handle);
+    bool resident(TextureHandle handle) const;
+    // Forgets every recorded load failure, so the next resolve reads those files again.
+    // Returns how many assets will be retried.
+    int retry_failed();
+
+    // Pinned assets are never evicted, neither explicitly nor by the budget.
+    void pin(MeshHandle handle, bool pinned = true);
+    void pin(TextureHandle handle, bool pinned = true);
+
+    // Meshes still referenced outside the registry are kept resident.
+    bool evict(MeshHandle handle);
+    bool evict(TextureHandle handle);
+    void evict_unused();
+
+    void set_budget(size_t bytes);
+    size_t get_budget() const { return budgetBytes; }
+    size_t resident_bytes() const { return residentBytes; }
+
+    const AssetStats& stats(MeshHandle handle) const { return meshes[handle.index].stats; }
+    const AssetStats& stats(TextureHandle handle) const { return textures[handle.index].stats; }
+    const std::string& path(MeshHandle handle) const { return meshes[handle.index].path; }
+    const std::string& path(TextureHandle handle) const { return textures[handle.index].path; }
+
+    // Advances the LRU clock and installs textures that finished streaming.
+    void begin_frame();
+    void print_stats() const;
+    void shutdown();
+};
+
+inline AssetRegistry gAssets;
@@ -0,0 +1,115 @@
+#include "core/render/cooked_texture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+size_t CookedTexture::byte_size() const {
+    size_t total = 0;
+    for (const auto& mip : mips)
+        total += mip.data.size();
+    return total;
+}
+
+size_t cooked_level_size(CookedFormat format, int width, int height) {
+    size_t blocksX = static_cast<size_t>((width + 3) / 4);
+    size_t blocksY = static_cast<size_t>((height + 3) / 4);
+    switch (format) {
+    case CookedFormat::BC1: return blocksX * blocksY * 8;
+    case CookedFormat::BC3:
+    case CookedFormat::BC5: return blocksX * blocksY * 16;
+    case CookedFormat::RGBA8:
+    default: return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+    }
+}
+
+const char* cooked_format_name(CookedFormat format) {
+    switch (format) {
+    case CookedFormat::RGBA8: return "RGBA8";
+    case CookedFormat::BC1: return "BC1";
+    case CookedFormat::BC3: return "BC3";
+    case CookedFormat::BC5: return "BC5";
+    default: return "Unknown";
+    }
+}
+
+std::string cooked_texture_path(const std::string& sourcePath) {
+    size_t slash = sourcePath.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "" : sourcePath.substr(0, slash);
+    std::string name = slash == std::string::npos ? sourcePath : sourcePath.substr(slash + 1);
+
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos)
+        name = name.substr(0, dot);
+
+    size_t parentSlash = dir.find_last_of('/');
+    std::string parent = parentSlash == std::string::npos ? "" : dir.substr(0, parentSlash + 1);
+    return parent + "cooked/" + name + ".ktex";
+}
+
+bool read_cooked_texture(const std::string& path, CookedTexture& out) {
+    FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    CookedHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, fp) == 1
+           && header.magic == COOKED_MAGIC
+           && header.version == COOKED_VERSION
+           && header.mipCount > 0 && header.mipCount <= 16;
+
+    out.format = header.format;
+    out.mips.clear();
+    int width = static_cast<int>(header.width);
+    int height = static_cast<int>(header.height);
+    for (uint32_t level = 0; ok && level < header.mipCount; ++level) {
+        uint32_t size = 0;
+        ok = std::fread(&size, sizeof(size), 1, fp) == 1
+          && size == cooked_level_size(header.format, width, height);
+        if (!ok)
+            break;
+
+        CookedMip mip;
+        mip.width = width;
+        mip.height = height;
+        mip.data.resize(size);
+        ok = std::fread(mip.data.data(), 1, size, fp) == size;
+        out.mips.push_back(std::move(mip));
+
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    std::fclose(fp);
+
+    if (!ok) {
+        std::cerr << "[Texture] Corrupt cooked texture " << path << '\n';
+        out.mips.clear();
+    }
+    return ok;
+}
+
+bool write_cooked_texture(const std::string& path, const CookedTexture& tex) {
+    if (tex.mips.empty())
+        return false;
+
+    FILE* fp = std::fopen(path.c_str(), "wb");
+    if (!fp) {
+        std::cerr << "[Texture] Failed to open " << path << " for writing\n";
+        return false;
+    }
+
+    CookedHeader header;
+    header.format = tex.format;
+    header.width = static_cast<uint32_t>(tex.mips.front().width);
+    header.height = static_cast<uint32_t>(tex.mips.front().height);
+    header.mipCount = static_cast<uint32_t>(tex.mips.size());
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1;
+    for (const auto& mip : tex.mips) {
+        uint32_t size = static_cast<uint32_t>(mip.data.size());
+        ok = ok && std::fwrite(&size, sizeof(size), 1, fp) == 1
+                && std::fwrite(mip.data.data(), 1, size, fp) == size;
+    }
+    std::fclose(fp);
+    return ok;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Offline-cooked texture container written by tools/texture_cooker.
+// Layout: CookedHeader, then mipCount x { uint32 byteSize; byteSize bytes },
+// largest level first. Rows are stored bottom-up, matching decode_png(flipY).
+enum class CookedFormat : uint32_t {
+    RGBA8 = 0,
+    BC1   = 1,  // opaque diffuse, 4 bpp
+    BC3   = 2,  // diffuse with alpha, 8 bpp
+    BC5   = 3,  // tangent-space normal XY, 8 bpp (Z rebuilt in the shader)
+};
+
+constexpr uint32_t COOKED_MAGIC = 0x5845544Bu; // "KTEX"
+constexpr uint32_t COOKED_VERSION = 1;
+
+struct CookedHeader {
+    uint32_t magic = COOKED_MAGIC;
+    uint32_t version = COOKED_VERSION;
+    CookedFormat format = CookedFormat::RGBA8;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 0;
+};
+
+struct CookedMip {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> data;
+};
+
+struct CookedTexture {
+    CookedFormat format = CookedFormat::RGBA8;
+    std::vector<CookedMip> mips;
+
+    size_t byte_size() const;
+};
+
+// Size of one mip level in the given format.
+size_t cooked_level_size(CookedFormat format, int width, int height);
+const char* cooked_format_name(CookedFormat format);
+
+// "assets/textures/foo.png" -> "assets/cooked/foo.ktex"
+std::string cooked_texture_path(const std::string& sourcePath);
+
+// A missing file is not an error (returns false quietly); a malformed one is logged.
+bool read_cooked_texture(const std::string& path, CookedTexture& out);
+bool write_cooked_texture(const std::string& path, const CookedTexture& tex);
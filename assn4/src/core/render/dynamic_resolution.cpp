@@ -0,0 +1,45 @@
+#include "core/render/dynamic_resolution.h"
+
+#include <algorithm>
+
+bool DynamicResolution::update(double gpuMs) {
+    if (!enabled)
+        return false;
+    smoothedMs = smoothedMs > 0.0 ? smoothedMs + (gpuMs - smoothedMs) * SMOOTHING : gpuMs;
+    if (cooldown > 0) {
+        --cooldown;
+        return false;
+    }
+
+    // Hysteresis band [GROW_BELOW * budget, budget]: inside it the scale holds.
+    if (smoothedMs > budgetMs) {
+        ++overFrames;
+        underFrames = 0;
+    }
+    else if (smoothedMs < budgetMs * GROW_BELOW) {
+        ++underFrames;
+        overFrames = 0;
+    }
+    else
+        overFrames = underFrames = 0;
+
+    int next = level;
+    if (overFrames >= SHRINK_FRAMES)
+        next = std::max(level - 1, MIN_LEVEL);
+    else if (underFrames >= GROW_FRAMES)
+        next = std::min(level + 1, MAX_LEVEL);
+    if (next == level)
+        return false;
+
+    level = next;
+    overFrames = underFrames = 0;
+    cooldown = COOLDOWN_FRAMES;
+    return true;
+}
+
+void DynamicResolution::set_enabled(bool on) {
+    enabled = on;
+    level = MAX_LEVEL;
+    smoothedMs = 0.0;
+    overFrames = underFrames = cooldown = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// Chooses the scene render scale from measured GPU frame time. The scale moves in
+// SCALE_STEP increments, so a target only needs reallocating when it really changes:
+// it drops after the smoothed time stays over budget for a few frames, and rises only
+// after a longer stretch well under budget. A cooldown after each change covers the
+// latency of the GPU timers.
+class DynamicResolution {
+private:
+    static constexpr int MIN_LEVEL = 5;          // scale = level * SCALE_STEP
+    static constexpr int MAX_LEVEL = 10;
+    static constexpr double SMOOTHING = 0.1;     // EMA weight of the newest sample
+    static constexpr double GROW_BELOW = 0.7;    // of the budget; the next step costs up to 1.44x
+    static constexpr int SHRINK_FRAMES = 5;
+    static constexpr int GROW_FRAMES = 60;
+    static constexpr int COOLDOWN_FRAMES = 15;
+
+    double budgetMs;
+    double smoothedMs = 0.0;
+    int level = MAX_LEVEL;
+    int overFrames = 0;
+    int underFrames = 0;
+    int cooldown = 0;
+    bool enabled = true;
+
+public:
+    static constexpr float SCALE_STEP = 0.1f;
+
+    explicit DynamicResolution(double _budgetMs) : budgetMs(_budgetMs) {}
+
+    // One GPU frame time sample per frame; returns true when the scale changed.
+    bool update(double gpuMs);
+
+    void set_budget(double ms) { budgetMs = ms; }
+    double get_budget() const { return budgetMs; }
+    // Disabling pins the scale at 1.
+    void set_enabled(bool on);
+    bool is_enabled() const { return enabled; }
+    float get_scale() const { return static_cast<float>(level) * SCALE_STEP; }
+    double smoothed_ms() const { return smoothedMs; }
+};
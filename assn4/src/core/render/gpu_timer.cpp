@@ -0,0 +1,69 @@
+#include "core/render/gpu_timer.h"
+
+#include <iostream>
+
+bool GpuTimer::init() {
+    if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query) {
+        std::cerr << "[GpuTimer] Timer queries are not supported" << std::endl;
+        return false;
+    }
+    glGenQueries(QUERY_COUNT, queries.data());
+    return true;
+}
+
+void GpuTimer::release() {
+    if (queries[0])
+        glDeleteQueries(QUERY_COUNT, queries.data());
+    queries.fill(0);
+    pending.fill(false);
+    running = false;
+}
+
+void GpuTimer::collect() {
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        if (!pending[i])
+            continue;
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+        pending[i] = false;
+        lastMs = static_cast<double>(ns) * 1e-6;
+        totalMs += lastMs;
+        ++samples;
+    }
+}
+
+void GpuTimer::begin() {
+    if (!queries[0] || running)
+        return;
+    collect();
+    if (pending[current])
+        return;
+    glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+    running = true;
+}
+
+void GpuTimer::end() {
+    if (!running)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[current] = true;
+    current = (current + 1) % QUERY_COUNT;
+    running = false;
+}
+
+void GpuTimer::reset() {
+    // Results from before the reset must not leak into the new average.
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        if (!pending[i])
+            continue;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+        pending[i] = false;
+    }
+    lastMs = totalMs = 0.0;
+    samples = 0;
+}
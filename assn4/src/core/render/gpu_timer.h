@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+// GL_TIME_ELAPSED query ring. Results are collected a few frames late, only once the
+// GPU reports them available, so timing a pass never stalls the CPU. A frame is left
+// untimed when every query in the ring is still in flight.
+// Elapsed-time queries cannot nest: only one GpuTimer may be running at a time.
+class GpuTimer {
+private:
+    static constexpr int QUERY_COUNT = 4;
+
+    std::array<GLuint, QUERY_COUNT> queries{};
+    std::array<bool, QUERY_COUNT> pending{};
+    int current = 0;
+    bool running = false;
+
+    double lastMs = 0.0;
+    double totalMs = 0.0;
+    uint64_t samples = 0;
+
+    void collect();
+
+public:
+    GpuTimer() = default;
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    bool init();
+    void release();
+
+    void begin();
+    void end();
+    // Drops the accumulated average (results still in flight are discarded too).
+    void reset();
+
+    double last_ms() const { return lastMs; }
+    double average_ms() const { return samples ? totalMs / static_cast<double>(samples) : 0.0; }
+    uint64_t sample_count() const { return samples; }
+};
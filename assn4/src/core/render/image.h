@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Decoded RGBA8 pixels (rows bottom-up when flipped for GL)
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Decode a PNG into RGBA8 without touching GL. Returns false on failure.
+bool decode_png(const std::string& path, Image& out, bool flipY = true);
@@ -0,0 +1,128 @@
+#include "core/render/indirect_draw.h"
+
+#include <cstdint>
+#include <iostream>
+
+namespace {
+constexpr size_t INITIAL_DRAWS = 1024;
+
+size_t grown_capacity(size_t capacity, size_t needed) {
+    capacity = capacity ? capacity : INITIAL_DRAWS;
+    while (capacity < needed)
+        capacity *= 2;
+    return capacity;
+}
+}
+
+bool IndirectDrawBuffer::init() {
+    bool multiDraw = GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+    bool baseInstance = GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+    if (!multiDraw || !baseInstance) {
+        std::cerr << "[Indirect] Multi-draw indirect is not supported, drawing in a loop" << std::endl;
+        return false;
+    }
+
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    maxDraws = static_cast<size_t>(maxTexels) / DRAW_DATA_TEXELS;
+
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &dataBuffer);
+    glGenBuffers(1, &drawIndexBuffer);
+    glGenTextures(1, &dataTexture);
+    reserve(INITIAL_DRAWS, INITIAL_DRAWS);
+    glBindTexture(GL_TEXTURE_BUFFER, dataTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, dataBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    return true;
+}
+
+// Buffers only ever grow; the texture keeps pointing at dataBuffer across reallocation.
+void IndirectDrawBuffer::reserve(size_t drawCount, size_t commandCount) {
+    if (drawCount > drawCapacity) {
+        drawCapacity = grown_capacity(drawCapacity, drawCount);
+        glBindBuffer(GL_TEXTURE_BUFFER, dataBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(drawCapacity * sizeof(DrawData)), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        std::vector<uint32_t> drawIndices(drawCapacity);
+        for (size_t i = 0; i < drawCapacity; ++i)
+            drawIndices[i] = static_cast<uint32_t>(i);
+        glBindBuffer(GL_ARRAY_BUFFER, drawIndexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(drawCapacity * sizeof(uint32_t)), drawIndices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        gMeshBuffer.set_draw_index_buffer(drawIndexBuffer);
+    }
+    if (commandCount > commandCapacity) {
+        commandCapacity = grown_capacity(commandCapacity, commandCount);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(commandCapacity * sizeof(DrawElementsIndirectCommand)),
+                     nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+}
+
+void IndirectDrawBuffer::clear() {
+    commands.clear();
+    draws.clear();
+    mergeable = false;
+}
+
+size_t IndirectDrawBuffer::begin_batch() {
+    mergeable = false;
+    return commands.size();
+}
+
+void IndirectDrawBuffer::add(const MeshRange& range, const DrawData& data) {
+    if (mergeable) {
+        DrawElementsIndirectCommand& last = commands.back();
+        if (last.firstIndex == range.firstIndex && last.baseVertex == range.baseVertex) {
+            ++last.instanceCount;
+            draws.push_back(data);
+            return;
+        }
+    }
+    commands.push_back({static_cast<GLuint>(range.indexCount), 1u, static_cast<GLuint>(range.firstIndex),
+                        range.baseVertex, static_cast<GLuint>(draws.size())});
+    draws.push_back(data);
+    mergeable = true;
+}
+
+void IndirectDrawBuffer::upload() {
+    reserve(draws.size(), commands.size());
+
+    // Orphan, then fill: the previous pass may still be reading the old storage
+    glBindBuffer(GL_TEXTURE_BUFFER, dataBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(drawCapacity * sizeof(DrawData)), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(draws.size() * sizeof(DrawData)), draws.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(commandCapacity * sizeof(DrawElementsIndirectCommand)),
+                 nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0,
+                    static_cast<GLsizeiptr>(commands.size() * sizeof(DrawElementsIndirectCommand)), commands.data());
+
+    glActiveTexture(GL_TEXTURE0 + DRAW_DATA_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, dataTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void IndirectDrawBuffer::draw(size_t first, size_t count) const {
+    if (count == 0)
+        return;
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                reinterpret_cast<const void*>(first * sizeof(DrawElementsIndirectCommand)),
+                                static_cast<GLsizei>(count), 0);
+}
+
+void IndirectDrawBuffer::release() {
+    if (commandBuffer) glDeleteBuffers(1, &commandBuffer);
+    if (dataBuffer) glDeleteBuffers(1, &dataBuffer);
+    if (drawIndexBuffer) glDeleteBuffers(1, &drawIndexBuffer);
+    if (dataTexture) glDeleteTextures(1, &dataTexture);
+    commandBuffer = dataBuffer = drawIndexBuffer = dataTexture = 0;
+    commandCapacity = drawCapacity = maxDraws = 0;
+    clear();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "core/render/mesh_buffer.h"
+
+// glMultiDrawElementsIndirect command, laid out as GL expects it.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Per-draw data of the INDIRECT shader variants, read as DRAW_DATA_TEXELS RGBA32F texels
+// of uDrawData. The material index rides in normalMatrix[0].w.
+struct DrawData {
+    glm::mat4 model;
+    glm::mat4 prevModel;
+    glm::vec4 normalMatrix[3];
+    glm::vec4 color;
+};
+constexpr int DRAW_DATA_TEXELS = 12;   // must match load_draw_data() in the vertex shaders
+static_assert(sizeof(DrawData) == DRAW_DATA_TEXELS * sizeof(glm::vec4), "DrawData must pack into texels");
+
+// Texture unit of uDrawData; 0-3 hold the diffuse, normal, shadow and array maps.
+constexpr int DRAW_DATA_UNIT = 4;
+
+// One pass worth of indirect commands and their per-draw data. Draw i of the pass is
+// instance baseInstance + i of a per-instance attribute (location 4) holding 0, 1, 2...,
+// so the shaders find their data without gl_DrawID (GL 4.6). Consecutive draws of the
+// same mesh range share a command as instances.
+class IndirectDrawBuffer {
+private:
+    GLuint commandBuffer = 0;
+    GLuint dataBuffer = 0;
+    GLuint dataTexture = 0;
+    GLuint drawIndexBuffer = 0;   // 0..drawCapacity-1, attached to the gMeshBuffer VAOs
+    size_t commandCapacity = 0;
+    size_t drawCapacity = 0;
+    size_t maxDraws = 0;          // GL_MAX_TEXTURE_BUFFER_SIZE / DRAW_DATA_TEXELS
+    bool mergeable = false;       // the next add() may extend the last command
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawData> draws;
+
+    void reserve(size_t drawCount, size_t commandCount);
+
+public:
+    IndirectDrawBuffer() = default;
+    ~IndirectDrawBuffer() = default;   // GL objects go in release()
+
+    IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+    IndirectDrawBuffer& operator=(const IndirectDrawBuffer&) = delete;
+
+    // Needs GL 4.3 / ARB_multi_draw_indirect and a honoured baseInstance (4.2 /
+    // ARB_base_instance); false leaves the object unusable and the caller on its loop.
+    bool init();
+    bool ready() const { return dataTexture != 0; }
+    // Largest pass the data texture can hold.
+    size_t max_draws() const { return maxDraws; }
+
+    void clear();
+    // Starts a run of commands that is drawn on its own; returns its first command.
+    size_t begin_batch();
+    void add(const MeshRange& range, const DrawData& data);
+    size_t command_count() const { return commands.size(); }
+    size_t draw_count() const { return draws.size(); }
+
+    // Uploads commands and draw data and binds uDrawData's texture unit.
+    void upload();
+    // Commands [first, first + count) of the last upload; the mesh VAO must be bound.
+    void draw(size_t first, size_t count) const;
+    void release();
+};
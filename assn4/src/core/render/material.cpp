@@ -0,0 +1,74 @@
+#include "core/render/material.h"
+
+#include <map>
+#include <tuple>
+
+MaterialId MaterialLibrary::create(const std::string& name, const MaterialDesc& desc) {
+    if (auto it = lookup.find(name); it != lookup.end())
+        return it->second;
+
+    Material m;
+    m.tint = desc.tint;
+    m.lighting = desc.lighting;
+    if (!desc.diffuse.empty()) {
+        m.diffuse = gAssets.texture_handle(desc.diffuse);
+        m.features |= MATERIAL_DIFFUSE;
+    }
+    if (!desc.normal.empty()) {
+        m.normal = gAssets.texture_handle(desc.normal);
+        m.features |= MATERIAL_NORMAL_MAP;
+    }
+    if (m.lighting)
+        m.features |= MATERIAL_LIGHTING;
+    m.packedDiffuse = packed_diffuse(m);
+
+    MaterialId id = static_cast<MaterialId>(materials.size());
+    materials.push_back(m);
+    lookup.emplace(name, id);
+    assign_batches();
+    return id;
+}
+
+MaterialId MaterialLibrary::find(const std::string& name) const {
+    if (auto it = lookup.find(name); it != lookup.end())
+        return it->second;
+    return INVALID_MATERIAL;
+}
+
+void MaterialLibrary::pack_diffuse_textures(const std::vector<std::string>& paths) {
+    for (const auto& path : paths)
+        packer.add(path);
+    for (const auto& m : materials)
+        if (m.has(MATERIAL_DIFFUSE))
+            packer.add(gAssets.path(m.diffuse));
+
+    packer.build();
+    for (auto& m : materials)
+        m.packedDiffuse = packed_diffuse(m);
+    assign_batches();
+}
+
+PackedTexture MaterialLibrary::packed_diffuse(const Material& m) const {
+    if (!m.has(MATERIAL_DIFFUSE))
+        return {};
+    int slot = packer.find(gAssets.path(m.diffuse));
+    return slot >= 0 ? packer.result(slot) : PackedTexture{};
+}
+
+void MaterialLibrary::assign_batches() {
+    // Key: the GL state a material binds (diffuse source, normal map, lighting).
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t, bool>, uint32_t> batches;
+    for (auto& m : materials) {
+        uint32_t diffuseKind = m.packedDiffuse.packed() ? 1u : 0u;
+        uint32_t diffuseKey = m.packedDiffuse.packed() ? m.packedDiffuse.texture : m.diffuse.index;
+        auto key = std::make_tuple(diffuseKind, diffuseKey, m.normal.index, m.lighting);
+        auto it = batches.emplace(key, static_cast<uint32_t>(batches.size())).first;
+        m.batch = it->second;
+    }
+}
+
+void MaterialLibrary::shutdown() {
+    packer.release();
+    for (auto& m : materials)
+        m.packedDiffuse = {};
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/render/asset_registry.h"
+#include "core/render/texture_pack.h"
+
+using MaterialId = uint32_t;
+constexpr MaterialId INVALID_MATERIAL = 0xFFFFFFFFu;
+
+// Shader features a material needs; derived from its textures and lighting flag.
+enum MaterialFeature : uint32_t {
+    MATERIAL_LIGHTING   = 1u << 0,
+    MATERIAL_DIFFUSE    = 1u << 1,
+    MATERIAL_NORMAL_MAP = 1u << 2,
+};
+
+struct Material {
+    TextureHandle diffuse;
+    TextureHandle normal;
+    glm::vec4 tint = glm::vec4(1.0f);
+    bool lighting = true;
+    uint32_t features = 0;
+
+    // Set by MaterialLibrary::pack_diffuse_textures() when the diffuse map was packed.
+    PackedTexture packedDiffuse;
+    // Materials with the same batch bind identical textures; only uniforms differ between them.
+    uint32_t batch = 0;
+
+    bool has(MaterialFeature f) const { return (features & f) != 0; }
+};
+
+struct MaterialDesc {
+    std::string diffuse;    // empty = untextured
+    std::string normal;     // empty = no normal map
+    glm::vec4 tint = glm::vec4(1.0f);
+    bool lighting = true;
+};
+
+class MaterialLibrary {
+private:
+    std::vector<Material> materials;
+    std::unordered_map<std::string, MaterialId> lookup;
+    TexturePacker packer;
+
+    PackedTexture packed_diffuse(const Material& m) const;
+    void assign_batches();
+
+public:
+    // Creates the material once; later calls with the same name return the shared id.
+    MaterialId create(const std::string& name, const MaterialDesc& desc);
+    MaterialId find(const std::string& name) const;
+
+    // Pack the given diffuse maps (plus those of existing materials) into a texture
+    // array / atlas. Materials created later with one of these paths use the packed copy.
+    void pack_diffuse_textures(const std::vector<std::string>& paths);
+    // Frees the packed textures; materials fall back to their own diffuse maps.
+    void shutdown();
+
+    const Material& get(MaterialId id) const { return materials[id]; }
+    size_t size() const { return materials.size(); }
+};
+
+inline MaterialLibrary gMaterials;
@@ -1,73 +1,18 @@
 #include "core/render/mesh.h"
+#include "core/render/asset_registry.h"
+#include "core/render/mesh_optimize.h"
+#include "core/render/mesh_simplify.h"
 
 #include <GL/glew.h>
 #include <algorithm>
-#include <array>
 #include <cmath>
-#include <fstream>
-#include <sstream>
 #include <string>
-#include <unordered_map>
 
 #include <glm/glm.hpp>
 
-
-// Anonymous namespace for helper functions
-namespace {
-struct FaceVertex {
-    int position = 0;
-    int normal = 0;
-    int texcoord = 0;
-};
-
-void parse_face_token(const std::string& token, FaceVertex& fv) {
-    // OBJ indices are 1-based, negative values refer from the end.
-    int v = 0, vt = 0, vn = 0;
-    size_t firstSlash = token.find('/');
-    if (firstSlash == std::string::npos) {
-        v = std::stoi(token);
-    } else {
-        size_t secondSlash = token.find('/', firstSlash + 1);
-        v = std::stoi(token.substr(0, firstSlash));
-        if (secondSlash == std::string::npos) {
-            if (firstSlash + 1 < token.size())
-                vt = std::stoi(token.substr(firstSlash + 1));
-        } else {
-            if (secondSlash > firstSlash + 1)
-                vt = std::stoi(token.substr(firstSlash + 1, secondSlash - firstSlash - 1));
-            if (secondSlash + 1 < token.size())
-                vn = std::stoi(token.substr(secondSlash + 1));
-        }
-    }
-
-    fv.position = v;
-    fv.normal = vn;
-    fv.texcoord = vt;
-}
-}
-
-
 void Mesh::release_gpu() {
-    if (m_vboTangents) {
-        glDeleteBuffers(1, &m_vboTangents);
-        m_vboTangents = 0;
-    }
-    if (m_vboTexcoords) {
-        glDeleteBuffers(1, &m_vboTexcoords);
-        m_vboTexcoords = 0;
-    }
-    if (m_vboNormals) {
-        glDeleteBuffers(1, &m_vboNormals);
-        m_vboNormals = 0;
-    }
-    if (m_vboPositions) {
-        glDeleteBuffers(1, &m_vboPositions);
-        m_vboPositions = 0;
-    }
-    if (m_vao) {
-        glDeleteVertexArrays(1, &m_vao);
-        m_vao = 0;
-    }
+    gMeshBuffer.free_range(m_range);
+    m_range = MeshRange{};
 }
 
 Mesh::~Mesh() {
@@ -75,154 +20,60 @@ Mesh::~Mesh() {
 }
 
 bool Mesh::load_from_obj(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open())
+    TriangleSoup soup;
+    if (!read_obj(path, soup))
         return false;
 
-    m_positions.clear();
-    m_normals.clear();
-    m_texcoords.clear();
-    m_tangents.clear();
     release_gpu();
-
-    std::vector<std::array<float, 3>> tempPositions;
-    std::vector<std::array<float, 3>> tempNormals;
-    std::vector<std::array<float, 2>> tempTexcoords;
-
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#')
-            continue;
-
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
-
-        if (prefix == "v") {
-            float x, y, z;
-            iss >> x >> y >> z;
-            tempPositions.push_back({x, y, z});
-        } else if (prefix == "vn") {
-            float x, y, z;
-            iss >> x >> y >> z;
-            tempNormals.push_back({x, y, z});
-        } else if (prefix == "vt") {
-            float u, v;
-            iss >> u >> v;
-            tempTexcoords.push_back({u, v});
-        } else if (prefix == "f") {
-            std::vector<FaceVertex> faceVertices;
-            std::string token;
-            while (iss >> token) {
-                FaceVertex fv{};
-                parse_face_token(token, fv);
-                faceVertices.push_back(fv);
-            }
-
-            if (faceVertices.size() < 3)
-                continue;
-
-            auto resolve_index = [&](int idx, const auto& container) -> const auto& {
-                if (idx > 0)
-                    return container[static_cast<size_t>(idx - 1)];
-                // Negative indices refer to relative positions from end
-                return container[static_cast<size_t>(container.size() + idx)];
-            };
-
-            for (size_t i = 1; i + 1 < faceVertices.size(); ++i) {
-                FaceVertex tri[3] = {faceVertices[0], faceVertices[i], faceVertices[i + 1]};
-                for (const auto& vert : tri) {
-                    const auto& pos = resolve_index(vert.position, tempPositions);
-                    m_positions.insert(m_positions.end(), {pos[0], pos[1], pos[2]});
-                    if (!tempNormals.empty() && vert.normal != 0) {
-                        const auto& nor = resolve_index(vert.normal, tempNormals);
-                        m_normals.insert(m_normals.end(), {nor[0], nor[1], nor[2]});
-                    }
-                    if (!tempTexcoords.empty() && vert.texcoord != 0) {
-                        const auto& uv = resolve_index(vert.texcoord, tempTexcoords);
-                        m_texcoords.insert(m_texcoords.end(), {uv[0], uv[1]});
-                    }
-                }
-            }
-        }
-    }
-
-    if (m_positions.empty())
+    m_lods.clear();
+    if (!build(std::move(soup)))
         return false;
+    if (triangle_count() >= LOD_MIN_TRIANGLES)
+        build_lods();
+    return true;
+}
 
-    // Generate flat normals if the OBJ did not provide any usable ones
-    if (m_normals.size() != m_positions.size()) {
-        m_normals.clear();
-        m_normals.resize(m_positions.size(), 0.0f);
-        for (size_t i = 0; i + 8 < m_positions.size(); i += 9) {
-            float ax = m_positions[i];
-            float ay = m_positions[i + 1];
-            float az = m_positions[i + 2];
-            float bx = m_positions[i + 3];
-            float by = m_positions[i + 4];
-            float bz = m_positions[i + 5];
-            float cx = m_positions[i + 6];
-            float cy = m_positions[i + 7];
-            float cz = m_positions[i + 8];
-
-            float ux = bx - ax;
-            float uy = by - ay;
-            float uz = bz - az;
-            float vx = cx - ax;
-            float vy = cy - ay;
-            float vz = cz - az;
+bool Mesh::build(TriangleSoup soup) {
+    if (soup.positions.empty())
+        return false;
+    m_positions = std::move(soup.positions);
+    m_normals = std::move(soup.normals);
+    m_texcoords = std::move(soup.texcoords);
+    m_tangents.clear();
 
-            float nx = uy * vz - uz * vy;
-            float ny = uz * vx - ux * vz;
-            float nz = ux * vy - uy * vx;
-            float length = std::sqrt(nx * nx + ny * ny + nz * nz);
-            if (length <= 0.0f)
-                length = 1.0f;
-            nx /= length;
-            ny /= length;
-            nz /= length;
+    // Index, then order triangles for the post-transform cache and overdraw, and
+    // vertices for fetch locality.
+    std::vector<VertexStream> streams = {{&m_positions, 3}, {&m_normals, 3}};
+    if (!m_texcoords.empty())
+        streams.push_back({&m_texcoords, 2});
+    m_indices = weld_vertices(streams);
+    optimize_mesh(m_indices, streams);
 
+    // Generate tangents if UVs exist, averaged over the triangles sharing each vertex
+    if (!m_texcoords.empty()) {
+        m_tangents.assign(m_positions.size(), 0.0f);
+        for (size_t i = 0; i + 2 < m_indices.size(); i += 3) {
+            const uint32_t tri[3] = {m_indices[i], m_indices[i + 1], m_indices[i + 2]};
+            glm::vec3 p[3];
+            glm::vec2 uv[3];
             for (int v = 0; v < 3; ++v) {
-                size_t base = i + v * 3;
-                m_normals[base] = nx;
-                m_normals[base + 1] = ny;
-                m_normals[base + 2] = nz;
+                p[v] = glm::vec3(m_positions[tri[v] * 3], m_positions[tri[v] * 3 + 1], m_positions[tri[v] * 3 + 2]);
+                uv[v] = glm::vec2(m_texcoords[tri[v] * 2], m_texcoords[tri[v] * 2 + 1]);
             }
-        }
-    }
-
-    // Decide texcoord/tangent availability (drop partial data to keep buffer sizes aligned)
-    m_hasTexcoords = (m_texcoords.size() == (m_positions.size() / 3) * 2);
-    if (!m_hasTexcoords)
-        m_texcoords.clear();
 
-    // Generate tangents if UVs exist
-    if (m_hasTexcoords) {
-        m_tangents.assign(m_positions.size(), 0.0f);
-        for (size_t i = 0; i + 8 < m_positions.size(); i += 9) {
-            glm::vec3 p0(m_positions[i],     m_positions[i + 1], m_positions[i + 2]);
-            glm::vec3 p1(m_positions[i + 3], m_positions[i + 4], m_positions[i + 5]);
-            glm::vec3 p2(m_positions[i + 6], m_positions[i + 7], m_positions[i + 8]);
-
-            size_t uvBase = (i / 3) * 2;
-            glm::vec2 uv0(m_texcoords[uvBase],     m_texcoords[uvBase + 1]);
-            glm::vec2 uv1(m_texcoords[uvBase + 2], m_texcoords[uvBase + 3]);
-            glm::vec2 uv2(m_texcoords[uvBase + 4], m_texcoords[uvBase + 5]);
-
-            glm::vec3 edge1 = p1 - p0;
-            glm::vec3 edge2 = p2 - p0;
-            glm::vec2 dUV1 = uv1 - uv0;
-            glm::vec2 dUV2 = uv2 - uv0;
+            glm::vec3 edge1 = p[1] - p[0];
+            glm::vec3 edge2 = p[2] - p[0];
+            glm::vec2 dUV1 = uv[1] - uv[0];
+            glm::vec2 dUV2 = uv[2] - uv[0];
 
             float det = dUV1.x * dUV2.y - dUV1.y * dUV2.x;
             float invDet = (std::abs(det) < 1e-6f) ? 1.0f : 1.0f / det;
             glm::vec3 tangent = invDet * (edge1 * dUV2.y - edge2 * dUV1.y);
 
-            for (int v = 0; v < 3; ++v) {
-                size_t base = i + v * 3;
-                m_tangents[base]     += tangent.x;
-                m_tangents[base + 1] += tangent.y;
-                m_tangents[base + 2] += tangent.z;
+            for (uint32_t v : tri) {
+                m_tangents[v * 3]     += tangent.x;
+                m_tangents[v * 3 + 1] += tangent.y;
+                m_tangents[v * 3 + 2] += tangent.z;
             }
         }
 
@@ -237,93 +88,114 @@ bool Mesh::load_from_obj(const std::string& path) {
         }
     }
 
-    // Setup GPU buffers (Shader-compatible)
+    glm::vec3 lo(m_positions[0], m_positions[1], m_positions[2]);
+    glm::vec3 hi = lo;
+    for (size_t i = 0; i + 2 < m_positions.size(); i += 3) {
+        glm::vec3 p(m_positions[i], m_positions[i + 1], m_positions[i + 2]);
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    m_boundsCenter = (lo + hi) * 0.5f;
+    m_boundsRadius = 0.0f;
+    for (size_t i = 0; i + 2 < m_positions.size(); i += 3) {
+        glm::vec3 p(m_positions[i], m_positions[i + 1], m_positions[i + 2]);
+        m_boundsRadius = std::max(m_boundsRadius, glm::length(p - m_boundsCenter));
+    }
+
     m_vertexCount = static_cast<GLsizei>(m_positions.size() / 3);
+    m_indexCount = static_cast<GLsizei>(m_indices.size());
     m_hasNormals = (m_normals.size() == m_positions.size());
     m_hasTexcoords = (m_texcoords.size() == static_cast<size_t>(m_vertexCount) * 2);
     m_hasTangents = (m_tangents.size() == m_positions.size());
 
-    // Generate and bind VAO and VBO
-    glGenVertexArrays(1, &m_vao);
-    glGenBuffers(1, &m_vboPositions);
-
-    // Bind VAO and VBO
-    glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vboPositions);
-
-    // VBO data upload
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_positions.size() * sizeof(float)),
-                 m_positions.data(), GL_STATIC_DRAW);
-    // VAO attribute setup
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-    // Normals VBO setup if available
-    if (m_hasNormals) {
-        glGenBuffers(1, &m_vboNormals);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vboNormals);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_normals.size() * sizeof(float)),
-                     m_normals.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    } else {
-        glDisableVertexAttribArray(1);
+    // Interleave into the shared buffer's format; missing streams stay zero
+    std::vector<MeshVertex> vertices(m_vertexCount, MeshVertex{});
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        vertices[v].position = glm::vec3(m_positions[v * 3], m_positions[v * 3 + 1], m_positions[v * 3 + 2]);
+        if (m_hasNormals)
+            vertices[v].normal = glm::vec3(m_normals[v * 3], m_normals[v * 3 + 1], m_normals[v * 3 + 2]);
+        if (m_hasTexcoords)
+            vertices[v].texcoord = glm::vec2(m_texcoords[v * 2], m_texcoords[v * 2 + 1]);
+        if (m_hasTangents)
+            vertices[v].tangent = glm::vec3(m_tangents[v * 3], m_tangents[v * 3 + 1], m_tangents[v * 3 + 2]);
     }
+    m_range = gMeshBuffer.upload(vertices, m_indices);
+    return m_range.valid();
+}
 
-    // Texcoords VBO setup if available
-    if (m_hasTexcoords) {
-        glGenBuffers(1, &m_vboTexcoords);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vboTexcoords);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_texcoords.size() * sizeof(float)),
-                     m_texcoords.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-    } else {
-        glDisableVertexAttribArray(2);
+void Mesh::build_lods() {
+    TriangleSoup soup = triangles();
+    std::vector<size_t> targets;
+    size_t target = soup.triangle_count();
+    for (int level = 1; level < MAX_LODS; ++level)
+        targets.push_back(target /= 2);
+
+    m_lods.clear();
+    size_t previous = soup.triangle_count();
+    for (auto& level : simplify_mesh(soup, targets)) {
+        // a level the simplifier could not reduce any further adds nothing
+        if (level.triangle_count() == 0 || level.triangle_count() >= previous)
+            break;
+        previous = level.triangle_count();
+
+        auto mesh = std::make_unique<Mesh>();
+        if (!mesh->build(std::move(level)))
+            break;
+        // keep the full-detail bounds so every level switches at the same distance
+        mesh->m_boundsCenter = m_boundsCenter;
+        mesh->m_boundsRadius = m_boundsRadius;
+        m_lods.push_back(std::move(mesh));
     }
+}
 
-    // Tangents VBO setup if available
-    if (m_hasTangents) {
-        glGenBuffers(1, &m_vboTangents);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vboTangents);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_tangents.size() * sizeof(float)),
-                     m_tangents.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    } else {
-        glDisableVertexAttribArray(3);
+TriangleSoup Mesh::triangles() const {
+    TriangleSoup soup;
+    soup.positions.reserve(m_indices.size() * 3);
+    soup.normals.reserve(m_indices.size() * 3);
+    for (uint32_t v : m_indices) {
+        soup.positions.insert(soup.positions.end(), {m_positions[v * 3], m_positions[v * 3 + 1], m_positions[v * 3 + 2]});
+        soup.normals.insert(soup.normals.end(), {m_normals[v * 3], m_normals[v * 3 + 1], m_normals[v * 3 + 2]});
+        if (m_hasTexcoords)
+            soup.texcoords.insert(soup.texcoords.end(), {m_texcoords[v * 2], m_texcoords[v * 2 + 1]});
     }
-    
-    // Unbind to avoid accidental modification
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return soup;
+}
 
-    return true;
+const Mesh& Mesh::lod(int level) const {
+    if (level <= 0 || m_lods.empty())
+        return *this;
+    return *m_lods[std::min(level, static_cast<int>(m_lods.size())) - 1];
 }
 
 void Mesh::draw() const {
-    if (!m_vao)
+    if (!m_range.valid())
         return;
 
-    glBindVertexArray(m_vao);
-    glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
-    glBindVertexArray(0);
+    gMeshBuffer.bind();
+    glDrawElementsBaseVertex(GL_TRIANGLES, m_range.indexCount, GL_UNSIGNED_INT, m_range.index_offset(),
+                             m_range.baseVertex);
 }
 
+void Mesh::draw_positions(GLsizei instanceCount) const {
+    if (!m_range.valid())
+        return;
 
-// [free function] Global mesh loading function with caching
-std::shared_ptr<Mesh> load_mesh(const std::string& path) {
-    static std::unordered_map<std::string, std::weak_ptr<Mesh>> cache;
+    gMeshBuffer.bind_positions();
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_range.indexCount, GL_UNSIGNED_INT, m_range.index_offset(),
+                                      instanceCount, m_range.baseVertex);
+}
 
-    if (auto it = cache.find(path); it != cache.end()) {
-        if (auto existing = it->second.lock())
-            return existing;
-    }
 
-    auto mesh = std::make_shared<Mesh>();
-    if (!mesh->load_from_obj(path))
-        return nullptr;
+size_t Mesh::byte_size() const {
+    size_t floats = m_positions.size() + m_normals.size() + m_texcoords.size() + m_tangents.size();
+    size_t bytes = (floats * sizeof(float) + m_indices.size() * sizeof(uint32_t)) * 2; // CPU copy + GPU buffers
+    for (const auto& level : m_lods)
+        bytes += level->byte_size();
+    return bytes;
+}
+
 
-    cache[path] = mesh;
-    return mesh;
+// [free function] Global mesh loading function backed by the asset registry
+std::shared_ptr<Mesh> load_mesh(const std::string& path) {
+    return gAssets.mesh(gAssets.mesh_handle(path));
 }
@@ -1,30 +1,45 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "core/render/mesh_buffer.h"
+#include "core/render/obj_file.h"
 
 class Mesh {
+public:
+    static constexpr int MAX_LODS = 4;                 // full detail + 3 simplified levels
+    static constexpr GLsizei LOD_MIN_TRIANGLES = 500;  // smaller meshes are drawn as is
+
 private:
     std::vector<float> m_positions; // interleaved as xyz
     std::vector<float> m_normals;   // interleaved as xyz
     std::vector<float> m_texcoords; // interleaved as uv
     std::vector<float> m_tangents;  // interleaved as xyz (for normal mapping)
+    std::vector<uint32_t> m_indices; // triangle list over the unique vertices above
     
-    // for Shader-compatible rendering
-    GLuint m_vao = 0;
-    GLuint m_vboPositions = 0;
-    GLuint m_vboNormals = 0;
-    GLuint m_vboTexcoords = 0;
-    GLuint m_vboTangents = 0;
+    // Sub-range of the shared vertex/index buffers (gMeshBuffer)
+    MeshRange m_range;
     GLsizei m_vertexCount = 0;
+    GLsizei m_indexCount = 0;
     bool m_hasNormals = false;
     bool m_hasTexcoords = false;
     bool m_hasTangents = false;
+    glm::vec3 m_boundsCenter = glm::vec3(0.0f);
+    float m_boundsRadius = 0.0f;
+    // Quadric-simplified copies, each about half the triangles of the previous level
+    std::vector<std::unique_ptr<Mesh>> m_lods;
 
     void release_gpu();
+    // Indexes and reorders the soup (mesh_optimize), adds tangents, computes bounds and
+    // uploads into gMeshBuffer.
+    bool build(TriangleSoup soup);
+    void build_lods();
 
 public:
     Mesh() = default;
@@ -41,12 +56,32 @@ public:
     const std::vector<float>& normals() const { return m_normals; }
     const std::vector<float>& texcoords() const { return m_texcoords; }
     const std::vector<float>& tangents() const { return m_tangents; }
+    const std::vector<uint32_t>& indices() const { return m_indices; }
+    // Non-indexed copy, one entry per triangle corner
+    TriangleSoup triangles() const;
     bool has_normals() const { return m_hasNormals; }
     bool has_texcoords() const { return m_hasTexcoords; }
     bool has_tangents() const { return m_hasTangents; }
+    GLsizei vertex_count() const { return m_vertexCount; }
+    GLsizei triangle_count() const { return m_indexCount / 3; }
+    size_t byte_size() const;   // includes the LODs
+
+    // Object-space bounding sphere, for screen-size LOD selection
+    const glm::vec3& bounds_center() const { return m_boundsCenter; }
+    float bounds_radius() const { return m_boundsRadius; }
+    // Level 0 is this mesh; levels past lod_count() - 1 clamp to the coarsest.
+    int lod_count() const { return 1 + static_cast<int>(m_lods.size()); }
+    const Mesh& lod(int level) const;
+
+    const MeshRange& range() const { return m_range; }
 
     bool load_from_obj(const std::string& path);
+    // Both draws bind a shared VAO and leave it bound, so consecutive mesh draws never
+    // switch VAOs; the caller unbinds once after its batch.
     void draw() const;
+    // Position-only draw for depth passes; instanced when instanceCount > 1.
+    void draw_positions(GLsizei instanceCount = 1) const;
 };
 
+// Resolve through the asset registry; the mesh stays resident until evicted.
 std::shared_ptr<Mesh> load_mesh(const std::string& path);
@@ -0,0 +1,180 @@
+#include "core/render/mesh_buffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+void MeshBuffer::init() {
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(INITIAL_VERTICES * sizeof(MeshVertex)), nullptr, GL_STATIC_DRAW);
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(INITIAL_INDICES * sizeof(uint32_t)), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    vertexCapacity = INITIAL_VERTICES;
+    indexCapacity = INITIAL_INDICES;
+    freeVertices = {{0, vertexCapacity}};
+    freeIndices = {{0, indexCapacity}};
+
+    glGenVertexArrays(1, &vao);
+    glGenVertexArrays(1, &vaoPositions);
+    setup_vaos();
+}
+
+// Called again whenever a buffer is replaced by a larger one.
+void MeshBuffer::setup_vaos() {
+    GLsizei stride = sizeof(MeshVertex);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, texcoord));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, tangent));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+    glBindVertexArray(vaoPositions);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, position));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+    for (GLuint array : {vao, vaoPositions}) {
+        glBindVertexArray(array);
+        glBindBuffer(GL_ARRAY_BUFFER, drawIndexBuffer);
+        if (drawIndexBuffer) {
+            glEnableVertexAttribArray(4);
+            glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+            glVertexAttribDivisor(4, 1);
+        }
+        else {
+            glDisableVertexAttribArray(4);
+        }
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffer::grow(GLuint& buffer, size_t& capacity, size_t elementSize, size_t minCapacity,
+                      std::vector<Block>& freeList) {
+    size_t newCapacity = capacity;
+    while (newCapacity < minCapacity)
+        newCapacity *= 2;
+
+    GLuint bigger = 0;
+    glGenBuffers(1, &bigger);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, bigger);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newCapacity * elementSize), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(capacity * elementSize));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+
+    free_block(freeList, capacity, newCapacity - capacity);
+    std::cout << "[MeshBuffer] Grew " << (elementSize == sizeof(MeshVertex) ? "vertex" : "index") << " buffer to "
+              << newCapacity << " entries (" << newCapacity * elementSize / 1024 << " KB)\n";
+    buffer = bigger;
+    capacity = newCapacity;
+    setup_vaos();
+}
+
+bool MeshBuffer::allocate(std::vector<Block>& freeList, size_t count, size_t& offset) {
+    for (auto it = freeList.begin(); it != freeList.end(); ++it) {
+        if (it->count < count)
+            continue;
+        offset = it->offset;
+        it->offset += count;
+        it->count -= count;
+        if (it->count == 0)
+            freeList.erase(it);
+        return true;
+    }
+    return false;
+}
+
+void MeshBuffer::free_block(std::vector<Block>& freeList, size_t offset, size_t count) {
+    auto it = std::lower_bound(freeList.begin(), freeList.end(), offset,
+                               [](const Block& block, size_t value) { return block.offset < value; });
+    it = freeList.insert(it, {offset, count});
+    // merge with the following block, then with the preceding one
+    auto next = it + 1;
+    if (next != freeList.end() && it->offset + it->count == next->offset) {
+        it->count += next->count;
+        freeList.erase(next);
+    }
+    if (it != freeList.begin()) {
+        auto prev = it - 1;
+        if (prev->offset + prev->count == it->offset) {
+            prev->count += it->count;
+            freeList.erase(it);
+        }
+    }
+}
+
+MeshRange MeshBuffer::upload(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices) {
+    if (vertices.empty() || indices.empty())
+        return {};
+    if (!vao)
+        init();
+
+    size_t vertexOffset = 0, indexOffset = 0;
+    if (!allocate(freeVertices, vertices.size(), vertexOffset)) {
+        grow(vbo, vertexCapacity, sizeof(MeshVertex), vertexCapacity + vertices.size(), freeVertices);
+        allocate(freeVertices, vertices.size(), vertexOffset);
+    }
+    if (!allocate(freeIndices, indices.size(), indexOffset)) {
+        grow(ebo, indexCapacity, sizeof(uint32_t), indexCapacity + indices.size(), freeIndices);
+        allocate(freeIndices, indices.size(), indexOffset);
+    }
+
+    // Copy targets, so no VAO's element buffer binding is touched
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(vertexOffset * sizeof(MeshVertex)),
+                    static_cast<GLsizeiptr>(vertices.size() * sizeof(MeshVertex)), vertices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(indexOffset * sizeof(uint32_t)),
+                    static_cast<GLsizeiptr>(indices.size() * sizeof(uint32_t)), indices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    usedVertices += vertices.size();
+    usedIndices += indices.size();
+
+    MeshRange range;
+    range.baseVertex = static_cast<GLint>(vertexOffset);
+    range.vertexCount = static_cast<GLsizei>(vertices.size());
+    range.firstIndex = indexOffset;
+    range.indexCount = static_cast<GLsizei>(indices.size());
+    return range;
+}
+
+void MeshBuffer::free_range(const MeshRange& range) {
+    if (!range.valid() || !vao)
+        return;   // nothing allocated, or the buffers are already released
+    free_block(freeVertices, static_cast<size_t>(range.baseVertex), static_cast<size_t>(range.vertexCount));
+    free_block(freeIndices, range.firstIndex, static_cast<size_t>(range.indexCount));
+    usedVertices -= range.vertexCount;
+    usedIndices -= range.indexCount;
+}
+
+void MeshBuffer::set_draw_index_buffer(GLuint buffer) {
+    drawIndexBuffer = buffer;
+    if (vao)
+        setup_vaos();
+}
+
+void MeshBuffer::release() {
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (vaoPositions) glDeleteVertexArrays(1, &vaoPositions);
+    if (vbo) glDeleteBuffers(1, &vbo);
+    if (ebo) glDeleteBuffers(1, &ebo);
+    vao = vaoPositions = vbo = ebo = drawIndexBuffer = 0;
+    vertexCapacity = indexCapacity = usedVertices = usedIndices = 0;
+    freeVertices.clear();
+    freeIndices.clear();
+}
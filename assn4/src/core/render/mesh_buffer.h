@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Interleaved vertex of the shared buffer; attribute locations 0 position, 1 normal,
+// 2 uv, 3 tangent. Streams a mesh lacks are zero.
+struct MeshVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texcoord;
+    glm::vec3 tangent;
+};
+
+// Where a mesh lives in the shared buffers. Indices are relative to baseVertex
+// (glDrawElementsBaseVertex).
+struct MeshRange {
+    GLint baseVertex = 0;
+    GLsizei vertexCount = 0;
+    size_t firstIndex = 0;
+    GLsizei indexCount = 0;
+
+    bool valid() const { return indexCount > 0; }
+    const void* index_offset() const { return reinterpret_cast<const void*>(firstIndex * sizeof(uint32_t)); }
+};
+
+// One vertex buffer and one index buffer for every loaded mesh, with one VAO for the
+// full vertex format and one reading positions only (depth passes). Ranges come from
+// first-fit free lists; a buffer without room doubles and copies its contents on the GPU.
+class MeshBuffer {
+private:
+    static constexpr size_t INITIAL_VERTICES = 1 << 16;
+    static constexpr size_t INITIAL_INDICES = 1 << 17;
+
+    struct Block {
+        size_t offset;
+        size_t count;
+    };
+
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+    GLuint vao = 0;
+    GLuint vaoPositions = 0;
+    GLuint drawIndexBuffer = 0;   // per-instance draw index (location 4), owned by the indirect path
+    size_t vertexCapacity = 0;
+    size_t indexCapacity = 0;
+    size_t usedVertices = 0;
+    size_t usedIndices = 0;
+    std::vector<Block> freeVertices;   // sorted by offset, adjacent blocks merged
+    std::vector<Block> freeIndices;
+
+    void init();
+    void setup_vaos();
+    void grow(GLuint& buffer, size_t& capacity, size_t elementSize, size_t minCapacity, std::vector<Block>& freeList);
+    static bool allocate(std::vector<Block>& freeList, size_t count, size_t& offset);
+    static void free_block(std::vector<Block>& freeList, size_t offset, size_t count);
+
+public:
+    MeshBuffer() = default;
+    ~MeshBuffer() = default;   // GL objects go in release(), while the context is alive
+
+    MeshBuffer(const MeshBuffer&) = delete;
+    MeshBuffer& operator=(const MeshBuffer&) = delete;
+
+    MeshRange upload(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices);
+    void free_range(const MeshRange& range);
+    void release();
+    // Attaches a buffer of 0, 1, 2... as the per-instance attribute at location 4 of both
+    // VAOs, which multi-draw indirect offsets by each command's baseInstance.
+    void set_draw_index_buffer(GLuint buffer);
+
+    // The shared VAO stays bound across consecutive mesh draws; unbind once after a batch.
+    void bind() const { glBindVertexArray(vao); }
+    void bind_positions() const { glBindVertexArray(vaoPositions); }
+
+    size_t used_vertices() const { return usedVertices; }
+    size_t used_indices() const { return usedIndices; }
+    size_t byte_size() const { return vertexCapacity * sizeof(MeshVertex) + indexCapacity * sizeof(uint32_t); }
+};
+
+inline MeshBuffer gMeshBuffer;
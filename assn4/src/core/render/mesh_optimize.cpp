@@ -0,0 +1,361 @@
+#include "core/render/mesh_optimize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+namespace {
+// Forsyth's scoring constants (https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html)
+constexpr size_t CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+constexpr int OVERDRAW_CACHE_SIZE = 16;   // FIFO model used to find cheap cluster splits
+constexpr int OVERDRAW_CHECK_RESOLUTION = 64;   // coarse analyze_overdraw() that accepts the cluster order
+
+float vertex_score(int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0)
+        return -1.0f;
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = LAST_TRIANGLE_SCORE;   // the previous triangle's vertices: fixed, so strips are not overly favoured
+        } else {
+            float scaler = 1.0f / (CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+    // Vertices with few triangles left are finished first, so they leave no stragglers.
+    return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+}
+
+// Cache misses per triangle under a FIFO cache.
+std::vector<int> fifo_misses(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize) {
+    std::vector<size_t> stamp(vertexCount, 0);   // time the vertex entered the cache; 0 = never
+    size_t time = cacheSize + 1;                 // so stamp 0 always counts as evicted
+    std::vector<int> misses(indices.size() / 3, 0);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        uint32_t v = indices[i];
+        if (time - stamp[v] > static_cast<size_t>(cacheSize)) {
+            stamp[v] = time++;
+            ++misses[i / 3];
+        }
+    }
+    return misses;
+}
+}
+
+std::vector<uint32_t> weld_vertices(const std::vector<VertexStream>& streams) {
+    size_t vertexCount = streams.empty() ? 0 : streams[0].data->size() / streams[0].components;
+    size_t stride = 0;
+    for (const auto& stream : streams)
+        stride += stream.components;
+
+    std::unordered_map<std::string, uint32_t> lookup;
+    lookup.reserve(vertexCount);
+    std::vector<uint32_t> indices(vertexCount);
+    std::vector<uint32_t> firstCorner;
+    std::string key(stride * sizeof(float), '\0');
+    for (size_t i = 0; i < vertexCount; ++i) {
+        size_t offset = 0;
+        for (const auto& stream : streams) {
+            std::memcpy(&key[offset], stream.data->data() + i * stream.components, stream.components * sizeof(float));
+            offset += stream.components * sizeof(float);
+        }
+        auto [it, inserted] = lookup.try_emplace(key, static_cast<uint32_t>(firstCorner.size()));
+        if (inserted)
+            firstCorner.push_back(static_cast<uint32_t>(i));
+        indices[i] = it->second;
+    }
+
+    for (const auto& stream : streams) {
+        std::vector<float> compact(firstCorner.size() * stream.components);
+        for (size_t v = 0; v < firstCorner.size(); ++v)
+            std::memcpy(&compact[v * stream.components], stream.data->data() + firstCorner[v] * stream.components,
+                        stream.components * sizeof(float));
+        *stream.data = std::move(compact);
+    }
+    return indices;
+}
+
+void optimize_vertex_cache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Per-vertex list of triangles not yet emitted: adjacency[offset[v] .. offset[v] + remaining[v])
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t v : indices)
+        ++remaining[v];
+    std::vector<uint32_t> offset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        offset[v + 1] = offset[v] + remaining[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(offset.begin(), offset.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vScore[v] = vertex_score(-1, remaining[v]);
+    std::vector<float> tScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; ++t)
+        tScore[t] = vScore[indices[t * 3]] + vScore[indices[t * 3 + 1]] + vScore[indices[t * 3 + 2]];
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<uint32_t> cache, nextCache;
+    size_t cursor = 0;   // fallback: first triangle not emitted yet, in input order
+    int best = static_cast<int>(std::max_element(tScore.begin(), tScore.end()) - tScore.begin());
+
+    while (result.size() < indices.size()) {
+        if (best < 0) {
+            while (emitted[cursor])
+                ++cursor;
+            best = static_cast<int>(cursor);
+        }
+        emitted[best] = true;
+        const uint32_t* tri = &indices[best * 3];
+        for (int k = 0; k < 3; ++k) {
+            uint32_t v = tri[k];
+            result.push_back(v);
+            uint32_t* begin = &adjacency[offset[v]];
+            uint32_t* last = begin + remaining[v] - 1;
+            *std::find(begin, last + 1, static_cast<uint32_t>(best)) = *last;
+            --remaining[v];
+        }
+
+        // The new triangle moves to the front; everything else shifts back.
+        nextCache.assign(tri, tri + 3);
+        for (uint32_t v : cache)
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                nextCache.push_back(v);
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            uint32_t v = nextCache[i];
+            cachePosition[v] = i < CACHE_SIZE ? static_cast<int>(i) : -1;
+            vScore[v] = vertex_score(cachePosition[v], remaining[v]);
+        }
+
+        // Only triangles touching the cache changed score; the best of them goes next.
+        best = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : nextCache) {
+            for (uint32_t a = offset[v]; a < offset[v] + remaining[v]; ++a) {
+                uint32_t t = adjacency[a];
+                tScore[t] = vScore[indices[t * 3]] + vScore[indices[t * 3 + 1]] + vScore[indices[t * 3 + 2]];
+                if (cachePosition[v] >= 0 && tScore[t] > bestScore) {
+                    bestScore = tScore[t];
+                    best = static_cast<int>(t);
+                }
+            }
+        }
+        if (nextCache.size() > CACHE_SIZE)
+            nextCache.resize(CACHE_SIZE);
+        cache.swap(nextCache);
+    }
+    indices.swap(result);
+}
+
+void optimize_overdraw(std::vector<uint32_t>& indices, const std::vector<float>& positions, float threshold) {
+    size_t triangleCount = indices.size() / 3;
+    size_t vertexCount = positions.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    std::vector<int> misses = fifo_misses(indices, vertexCount, OVERDRAW_CACHE_SIZE);
+    size_t totalMisses = 0;
+    for (int m : misses)
+        totalMisses += m;
+    float meshAcmr = static_cast<float>(totalMisses) / triangleCount;
+
+    // A triangle with three misses starts from a cold cache anyway: splitting there is
+    // free unless the cluster so far is already worse than the mesh average.
+    std::vector<size_t> clusterStart = {0};
+    size_t clusterMisses = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        size_t clusterTriangles = t - clusterStart.back();
+        if (misses[t] == 3 && clusterTriangles > 0
+            && static_cast<float>(clusterMisses) / clusterTriangles <= threshold * meshAcmr) {
+            clusterStart.push_back(t);
+            clusterMisses = 0;
+        }
+        clusterMisses += misses[t];
+    }
+    clusterStart.push_back(triangleCount);
+
+    auto vertex = [&](uint32_t v) { return glm::vec3(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]); };
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    struct Cluster { size_t begin, end; float key; };
+    std::vector<Cluster> clusters;
+    std::vector<glm::vec3> centers;
+    std::vector<glm::vec3> normals;
+    for (size_t c = 0; c + 1 < clusterStart.size(); ++c) {
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; ++t) {
+            glm::vec3 p0 = vertex(indices[t * 3]), p1 = vertex(indices[t * 3 + 1]), p2 = vertex(indices[t * 3 + 2]);
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);   // length = 2 x area
+            float a = glm::length(n);
+            center += (p0 + p1 + p2) / 3.0f * a;
+            normal += n;
+            area += a;
+        }
+        meshCenter += center;
+        meshArea += area;
+        centers.push_back(area > 0.0f ? center / area : center);
+        normals.push_back(normal);
+        clusters.push_back({clusterStart[c], clusterStart[c + 1], 0.0f});
+    }
+    if (clusters.size() < 2)
+        return;
+    if (meshArea > 0.0f)
+        meshCenter /= meshArea;
+
+    // Clusters far out along their own normal are likely occluders: draw them first.
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        float len = glm::length(normals[c]);
+        clusters[c].key = len > 0.0f ? glm::dot(centers[c] - meshCenter, normals[c] / len) : 0.0f;
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const auto& cluster : clusters)
+        result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+
+    // The sort key is a heuristic; keep the new order only where it measurably helps.
+    if (analyze_overdraw(result, positions, OVERDRAW_CHECK_RESOLUTION).overdraw
+        < analyze_overdraw(indices, positions, OVERDRAW_CHECK_RESOLUTION).overdraw)
+        indices.swap(result);
+}
+
+void optimize_vertex_fetch(std::vector<uint32_t>& indices, const std::vector<VertexStream>& streams) {
+    size_t vertexCount = streams.empty() ? 0 : streams[0].data->size() / streams[0].components;
+    constexpr uint32_t UNUSED = ~0u;
+    std::vector<uint32_t> remap(vertexCount, UNUSED);
+    std::vector<uint32_t> order;   // new index -> old index
+    for (uint32_t& v : indices) {
+        if (remap[v] == UNUSED) {
+            remap[v] = static_cast<uint32_t>(order.size());
+            order.push_back(v);
+        }
+        v = remap[v];
+    }
+
+    for (const auto& stream : streams) {
+        std::vector<float> reordered(order.size() * stream.components);
+        for (size_t v = 0; v < order.size(); ++v)
+            std::memcpy(&reordered[v * stream.components], stream.data->data() + order[v] * stream.components,
+                        stream.components * sizeof(float));
+        *stream.data = std::move(reordered);
+    }
+}
+
+void optimize_mesh(std::vector<uint32_t>& indices, const std::vector<VertexStream>& streams) {
+    if (streams.empty())
+        return;
+    optimize_vertex_cache(indices, streams[0].data->size() / streams[0].components);
+    optimize_overdraw(indices, *streams[0].data);
+    optimize_vertex_fetch(indices, streams);
+}
+
+VertexCacheStats analyze_vertex_cache(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize) {
+    VertexCacheStats stats;
+    if (indices.empty())
+        return stats;
+    std::vector<int> misses = fifo_misses(indices, vertexCount, cacheSize);
+    size_t transformed = 0;
+    for (int m : misses)
+        transformed += m;
+
+    std::vector<bool> used(vertexCount, false);
+    size_t unique = 0;
+    for (uint32_t v : indices)
+        if (!used[v]) {
+            used[v] = true;
+            ++unique;
+        }
+
+    stats.acmr = static_cast<float>(transformed) / (indices.size() / 3);
+    stats.atvr = unique ? static_cast<float>(transformed) / unique : 0.0f;
+    return stats;
+}
+
+OverdrawStats analyze_overdraw(const std::vector<uint32_t>& indices, const std::vector<float>& positions, int resolution) {
+    OverdrawStats stats;
+    size_t vertexCount = positions.size() / 3;
+    if (indices.size() < 3 || vertexCount == 0 || resolution < 1)
+        return stats;
+
+    auto vertex = [&](uint32_t v) { return glm::vec3(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]); };
+    glm::vec3 lo = vertex(0), hi = lo;
+    for (size_t v = 1; v < vertexCount; ++v) {
+        lo = glm::min(lo, vertex(static_cast<uint32_t>(v)));
+        hi = glm::max(hi, vertex(static_cast<uint32_t>(v)));
+    }
+    glm::vec3 center = (lo + hi) * 0.5f;
+    float radius = std::max(glm::length(hi - lo) * 0.5f, 1e-6f);
+    float toPixels = resolution / (2.0f * radius);
+
+    std::vector<glm::vec3> directions;
+    for (int axis = 0; axis < 3; ++axis)
+        for (float sign : {-1.0f, 1.0f}) {
+            glm::vec3 d(0.0f);
+            d[axis] = sign;
+            directions.push_back(d);
+        }
+    for (int corner = 0; corner < 8; ++corner)
+        directions.push_back(glm::normalize(glm::vec3(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f,
+                                                      corner & 4 ? 1.0f : -1.0f)));
+
+    std::vector<float> depth(static_cast<size_t>(resolution) * resolution);
+    size_t passes = 0, covered = 0;
+    for (const glm::vec3& d : directions) {
+        // Looking along d with right x up = -d, as in GL eye space, so front faces stay CCW.
+        glm::vec3 right = glm::normalize(glm::cross(std::abs(d.z) < 0.9f ? glm::vec3(0, 0, 1) : glm::vec3(1, 0, 0), d));
+        glm::vec3 up = glm::cross(right, d);
+        std::fill(depth.begin(), depth.end(), INFINITY);
+
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            glm::vec3 p[3];
+            for (int k = 0; k < 3; ++k) {
+                glm::vec3 q = vertex(indices[t + k]) - center;
+                p[k] = glm::vec3((glm::dot(q, right) + radius) * toPixels, (glm::dot(q, up) + radius) * toPixels, glm::dot(q, d));
+            }
+            float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+            if (area <= 0.0f)
+                continue;   // back facing or degenerate
+
+            int x0 = std::max(0, static_cast<int>(std::floor(std::min({p[0].x, p[1].x, p[2].x}))));
+            int x1 = std::min(resolution - 1, static_cast<int>(std::ceil(std::max({p[0].x, p[1].x, p[2].x}))));
+            int y0 = std::max(0, static_cast<int>(std::floor(std::min({p[0].y, p[1].y, p[2].y}))));
+            int y1 = std::min(resolution - 1, static_cast<int>(std::ceil(std::max({p[0].y, p[1].y, p[2].y}))));
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x) {
+                    float px = x + 0.5f, py = y + 0.5f;
+                    float w0 = (p[2].x - p[1].x) * (py - p[1].y) - (p[2].y - p[1].y) * (px - p[1].x);
+                    float w1 = (p[0].x - p[2].x) * (py - p[2].y) - (p[0].y - p[2].y) * (px - p[2].x);
+                    float w2 = (p[1].x - p[0].x) * (py - p[0].y) - (p[1].y - p[0].y) * (px - p[0].x);
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                        continue;
+                    float z = (w0 * p[0].z + w1 * p[1].z + w2 * p[2].z) / area;
+                    float& stored = depth[static_cast<size_t>(y) * resolution + x];
+                    if (z < stored) {
+                        covered += stored == INFINITY;
+                        stored = z;
+                        ++passes;
+                    }
+                }
+        }
+    }
+    stats.overdraw = covered ? static_cast<float>(passes) / covered : 0.0f;
+    return stats;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Load-time index/vertex ordering for triangle lists, GL-free so tools can share it.
+// The usual order is: weld_vertices, optimize_vertex_cache, optimize_overdraw,
+// optimize_vertex_fetch (optimize_mesh runs the last three).
+
+// One vertex attribute stored as `components` floats per vertex.
+struct VertexStream {
+    std::vector<float>* data;
+    int components;
+};
+
+// Merges vertices that are bit-identical in every stream. The streams shrink to the
+// unique vertices (first occurrence order); returns the index buffer.
+std::vector<uint32_t> weld_vertices(const std::vector<VertexStream>& streams);
+
+// Forsyth's linear-speed ordering, tuned for a 32-entry LRU post-transform cache.
+void optimize_vertex_cache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+// Splits the cache-ordered list into clusters where a split costs little cache
+// efficiency (cluster ACMR <= threshold x mesh ACMR), then draws outward-facing
+// clusters first so they occlude the rest (Sander et al., "Fast triangle reordering").
+// The new order is kept only if analyze_overdraw() (at a coarse resolution) measures
+// less overdraw than the input order; otherwise the indices are left as they were.
+void optimize_overdraw(std::vector<uint32_t>& indices, const std::vector<float>& positions,
+                       float threshold = 1.05f);
+
+// Renumbers vertices in first-use order and reorders the streams to match, so vertex
+// fetch walks memory forward. Unreferenced vertices are dropped.
+void optimize_vertex_fetch(std::vector<uint32_t>& indices, const std::vector<VertexStream>& streams);
+
+// streams[0] must be xyz positions.
+void optimize_mesh(std::vector<uint32_t>& indices, const std::vector<VertexStream>& streams);
+
+struct VertexCacheStats {
+    float acmr = 0.0f;   // transformed vertices per triangle (0.5 ideal, 3 worst)
+    float atvr = 0.0f;   // transformed vertices per unique vertex (1 ideal)
+};
+
+// FIFO cache simulation, the usual model for comparing orderings.
+VertexCacheStats analyze_vertex_cache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                      int cacheSize = 16);
+
+struct OverdrawStats {
+    float overdraw = 0.0f;   // depth-test passes per covered pixel (1 ideal)
+};
+
+// Rasterizes the list in index order (back faces culled, depth test less) into a
+// resolution^2 orthographic view from each of the 6 axis and 8 diagonal directions and
+// sums the passes; the number optimize_overdraw tries to bring down.
+OverdrawStats analyze_overdraw(const std::vector<uint32_t>& indices, const std::vector<float>& positions,
+                               int resolution = 256);
@@ -0,0 +1,312 @@
+#include "core/render/mesh_simplify.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <queue>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+namespace {
+constexpr double BORDER_WEIGHT = 1000.0;   // penalty plane along open edges
+constexpr double MIN_NORMAL_COS = 0.2;     // a collapse may not turn a triangle further than this
+
+// Symmetric 4x4 error quadric, upper triangle: aa ab ac ad bb bc bd cc cd dd.
+struct Quadric {
+    std::array<double, 10> m{};
+
+    static Quadric plane(const glm::dvec3& n, double d, double weight) {
+        Quadric q;
+        q.m = {n.x * n.x, n.x * n.y, n.x * n.z, n.x * d,
+               n.y * n.y, n.y * n.z, n.y * d,
+               n.z * n.z, n.z * d,
+               d * d};
+        for (double& v : q.m)
+            v *= weight;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        for (size_t i = 0; i < m.size(); ++i)
+            m[i] += other.m[i];
+        return *this;
+    }
+
+    double error(const glm::dvec3& p) const {
+        return m[0] * p.x * p.x + 2.0 * m[1] * p.x * p.y + 2.0 * m[2] * p.x * p.z + 2.0 * m[3] * p.x
+             + m[4] * p.y * p.y + 2.0 * m[5] * p.y * p.z + 2.0 * m[6] * p.y
+             + m[7] * p.z * p.z + 2.0 * m[8] * p.z
+             + m[9];
+    }
+
+    // Position minimising the error; false when the system is (nearly) singular.
+    bool optimum(glm::dvec3& out) const {
+        glm::dmat3 a(m[0], m[1], m[2],
+                     m[1], m[4], m[5],
+                     m[2], m[5], m[7]);
+        double det = glm::determinant(a);
+        if (std::abs(det) < 1e-12)
+            return false;
+        out = glm::inverse(a) * -glm::dvec3(m[3], m[6], m[8]);
+        return true;
+    }
+};
+
+struct Vertex {
+    glm::dvec3 pos;
+    Quadric q;
+    std::vector<int> tris;
+    uint32_t version = 0;   // bumped on every change; older heap entries are stale
+    bool removed = false;
+};
+
+struct Triangle {
+    std::array<int, 3> v;   // welded vertices; corner k keeps the attributes of source corner k
+    int source = 0;
+    bool removed = false;
+
+    bool has(int vertex) const { return v[0] == vertex || v[1] == vertex || v[2] == vertex; }
+};
+
+struct Candidate {
+    double cost;
+    int a, b;               // a collapses into b
+    uint32_t versionA, versionB;
+    glm::dvec3 target;
+
+    bool operator>(const Candidate& other) const { return cost > other.cost; }
+};
+
+class Simplifier {
+private:
+    const TriangleSoup& source;
+    std::vector<Vertex> vertices;
+    std::vector<Triangle> triangles;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+    size_t activeTriangles = 0;
+
+    glm::dvec3 corner(size_t index) const {
+        return glm::dvec3(source.positions[index * 3], source.positions[index * 3 + 1], source.positions[index * 3 + 2]);
+    }
+
+    void weld() {
+        std::map<std::array<float, 3>, int> lookup;
+        size_t corners = source.triangle_count() * 3;
+        std::vector<int> welded(corners);
+        for (size_t i = 0; i < corners; ++i) {
+            std::array<float, 3> key = {source.positions[i * 3], source.positions[i * 3 + 1], source.positions[i * 3 + 2]};
+            auto [it, inserted] = lookup.try_emplace(key, static_cast<int>(vertices.size()));
+            if (inserted) {
+                Vertex v;
+                v.pos = corner(i);
+                vertices.push_back(v);
+            }
+            welded[i] = it->second;
+        }
+        for (size_t t = 0; t < source.triangle_count(); ++t) {
+            Triangle tri;
+            tri.v = {welded[t * 3], welded[t * 3 + 1], welded[t * 3 + 2]};
+            tri.source = static_cast<int>(t);
+            // already degenerate after welding: contributes nothing, drop it now
+            tri.removed = tri.v[0] == tri.v[1] || tri.v[1] == tri.v[2] || tri.v[0] == tri.v[2];
+            if (!tri.removed) {
+                for (int v : tri.v)
+                    vertices[v].tris.push_back(static_cast<int>(triangles.size()));
+                ++activeTriangles;
+            }
+            triangles.push_back(tri);
+        }
+    }
+
+    void build_quadrics(std::map<std::pair<int, int>, int>& edgeUse) {
+        for (const auto& tri : triangles) {
+            if (tri.removed)
+                continue;
+            const glm::dvec3& p0 = vertices[tri.v[0]].pos;
+            glm::dvec3 n = glm::cross(vertices[tri.v[1]].pos - p0, vertices[tri.v[2]].pos - p0);
+            double len = glm::length(n);
+            if (len > 0.0) {
+                n /= len;
+                Quadric q = Quadric::plane(n, -glm::dot(n, p0), len * 0.5);   // area weighted
+                for (int v : tri.v)
+                    vertices[v].q += q;
+            }
+            for (int k = 0; k < 3; ++k) {
+                int a = tri.v[k], b = tri.v[(k + 1) % 3];
+                ++edgeUse[{std::min(a, b), std::max(a, b)}];
+            }
+        }
+
+        // Open edges: a plane through the edge, perpendicular to its triangle, keeps the border in place.
+        for (const auto& tri : triangles) {
+            if (tri.removed)
+                continue;
+            const glm::dvec3& p0 = vertices[tri.v[0]].pos;
+            glm::dvec3 n = glm::cross(vertices[tri.v[1]].pos - p0, vertices[tri.v[2]].pos - p0);
+            if (glm::length(n) <= 0.0)
+                continue;
+            n = glm::normalize(n);
+            for (int k = 0; k < 3; ++k) {
+                int a = tri.v[k], b = tri.v[(k + 1) % 3];
+                if (edgeUse[{std::min(a, b), std::max(a, b)}] != 1)
+                    continue;
+                glm::dvec3 edge = vertices[b].pos - vertices[a].pos;
+                glm::dvec3 m = glm::cross(edge, n);
+                double len = glm::length(m);
+                if (len <= 0.0)
+                    continue;
+                m /= len;
+                Quadric q = Quadric::plane(m, -glm::dot(m, vertices[a].pos), BORDER_WEIGHT * glm::dot(edge, edge));
+                vertices[a].q += q;
+                vertices[b].q += q;
+            }
+        }
+    }
+
+    void push_edge(int a, int b) {
+        Quadric q = vertices[a].q;
+        q += vertices[b].q;
+        glm::dvec3 target;
+        double cost;
+        if (q.optimum(target)) {
+            cost = q.error(target);
+        } else {
+            glm::dvec3 options[3] = {vertices[a].pos, vertices[b].pos, (vertices[a].pos + vertices[b].pos) * 0.5};
+            target = options[0];
+            cost = q.error(options[0]);
+            for (const auto& p : options) {
+                double e = q.error(p);
+                if (e < cost) {
+                    cost = e;
+                    target = p;
+                }
+            }
+        }
+        heap.push({std::max(cost, 0.0), a, b, vertices[a].version, vertices[b].version, target});
+    }
+
+    // Rejects collapses that would fold or degenerate a remaining triangle.
+    bool keeps_orientation(const Candidate& c) const {
+        for (int vertex : {c.a, c.b}) {
+            for (int t : vertices[vertex].tris) {
+                const Triangle& tri = triangles[t];
+                if (tri.removed || (tri.has(c.a) && tri.has(c.b)))
+                    continue;
+                glm::dvec3 before[3], after[3];
+                for (int k = 0; k < 3; ++k) {
+                    before[k] = vertices[tri.v[k]].pos;
+                    after[k] = (tri.v[k] == c.a || tri.v[k] == c.b) ? c.target : before[k];
+                }
+                glm::dvec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::dvec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+                double l0 = glm::length(n0), l1 = glm::length(n1);
+                if (l1 <= 1e-12)
+                    return false;
+                if (l0 > 1e-12 && glm::dot(n0, n1) / (l0 * l1) < MIN_NORMAL_COS)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void collapse(const Candidate& c) {
+        Vertex& a = vertices[c.a];
+        Vertex& b = vertices[c.b];
+        b.pos = c.target;
+        b.q += a.q;
+        ++b.version;
+        a.removed = true;
+
+        for (int t : a.tris) {
+            Triangle& tri = triangles[t];
+            if (tri.removed)
+                continue;
+            if (tri.has(c.b)) {
+                tri.removed = true;
+                --activeTriangles;
+                continue;
+            }
+            for (int& v : tri.v)
+                if (v == c.a)
+                    v = c.b;
+            b.tris.push_back(t);
+        }
+        a.tris.clear();
+
+        b.tris.erase(std::remove_if(b.tris.begin(), b.tris.end(), [&](int t) { return triangles[t].removed; }),
+                     b.tris.end());
+        std::sort(b.tris.begin(), b.tris.end());
+        b.tris.erase(std::unique(b.tris.begin(), b.tris.end()), b.tris.end());
+
+        std::vector<int> neighbours;
+        for (int t : b.tris)
+            for (int v : triangles[t].v)
+                if (v != c.b)
+                    neighbours.push_back(v);
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        for (int n : neighbours)
+            push_edge(c.b, n);
+    }
+
+    TriangleSoup snapshot() const {
+        TriangleSoup out;
+        bool hasUv = !source.texcoords.empty();
+        out.positions.reserve(activeTriangles * 9);
+        out.normals.reserve(activeTriangles * 9);
+        if (hasUv)
+            out.texcoords.reserve(activeTriangles * 6);
+        for (const auto& tri : triangles) {
+            if (tri.removed)
+                continue;
+            for (int k = 0; k < 3; ++k) {
+                const glm::dvec3& p = vertices[tri.v[k]].pos;
+                size_t src = static_cast<size_t>(tri.source) * 3 + k;
+                out.positions.insert(out.positions.end(), {static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)});
+                out.normals.insert(out.normals.end(), {source.normals[src * 3], source.normals[src * 3 + 1], source.normals[src * 3 + 2]});
+                if (hasUv)
+                    out.texcoords.insert(out.texcoords.end(), {source.texcoords[src * 2], source.texcoords[src * 2 + 1]});
+            }
+        }
+        return out;
+    }
+
+public:
+    explicit Simplifier(const TriangleSoup& _source) : source(_source) {}
+
+    std::vector<TriangleSoup> run(const std::vector<size_t>& targets) {
+        weld();
+        std::map<std::pair<int, int>, int> edgeUse;
+        build_quadrics(edgeUse);
+        for (const auto& [edge, uses] : edgeUse)
+            push_edge(edge.first, edge.second);
+
+        std::vector<TriangleSoup> levels;
+        for (size_t target : targets) {
+            while (activeTriangles > target && !heap.empty()) {
+                Candidate c = heap.top();
+                heap.pop();
+                const Vertex& a = vertices[c.a];
+                const Vertex& b = vertices[c.b];
+                if (a.removed || b.removed || a.version != c.versionA || b.version != c.versionB)
+                    continue;
+                if (!keeps_orientation(c))
+                    continue;
+                collapse(c);
+            }
+            levels.push_back(snapshot());
+        }
+        return levels;
+    }
+};
+}
+
+std::vector<TriangleSoup> simplify_mesh(const TriangleSoup& source, const std::vector<size_t>& targetTriangles) {
+    if (source.triangle_count() == 0 || source.normals.size() != source.positions.size())
+        return {};
+    return Simplifier(source).run(targetTriangles);
+}
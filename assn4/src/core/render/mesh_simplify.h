@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "core/render/obj_file.h"
+
+// Quadric error metric edge collapse (Garland & Heckbert). Vertices are welded by
+// position; normals and uvs stay with the triangle corners, so seams never block a
+// collapse (they may stretch slightly, which is fine at LOD distances). Open borders
+// get a strong penalty plane so silhouettes hold.
+//
+// One collapse sequence produces every level: the result holds one soup per entry of
+// targetTriangles (descending). A level can end above its target when no collapse
+// is left that keeps the surface from folding over.
+std::vector<TriangleSoup> simplify_mesh(const TriangleSoup& source, const std::vector<size_t>& targetTriangles);
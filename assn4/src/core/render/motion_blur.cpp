@@ -0,0 +1,57 @@
+#include "core/render/motion_blur.h"
+
+const char* motion_blur_mode_name(MotionBlurMode mode) {
+    switch (mode) {
+    case MotionBlurMode::Off:            return "Off";
+    case MotionBlurMode::Simple:         return "Simple";
+    case MotionBlurMode::Reconstruction: return "Reconstruction";
+    }
+    return "Unknown";
+}
+
+bool MotionBlurTiles::init() {
+    bool loaded = tileMaxProgram.load_from_files("core/render/shaders/blur.vert", "core/render/shaders/blur_tile_max.frag")
+               && neighborMaxProgram.load_from_files("core/render/shaders/blur.vert", "core/render/shaders/blur_neighbor_max.frag");
+    if (!loaded)
+        return false;
+
+    tileMaxProgram.bind();
+    glUniform1i(tileMaxProgram.uniform_location("velocityTexture"), 0);
+    glUniform1i(tileMaxProgram.uniform_location("uTileSize"), TILE_SIZE);
+    neighborMaxProgram.bind();
+    glUniform1i(neighborMaxProgram.uniform_location("tileMaxTexture"), 0);
+    neighborMaxProgram.unbind();
+    return true;
+}
+
+RenderTargetDesc MotionBlurTiles::target_desc(float sceneScale) {
+    RenderTargetDesc desc;
+    desc.color = { {GL_RG16F, GL_NEAREST} };
+    desc.scale = sceneScale;
+    desc.divisor = TILE_SIZE;
+    return desc;
+}
+
+namespace {
+void draw_tile_pass(const ShaderProgram& program, GLuint source, const std::function<void()>& drawQuad) {
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+    program.bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source);
+    drawQuad();
+    program.unbind();
+    if (blend)
+        glEnable(GL_BLEND);
+}
+}
+
+// 1. tile max: one fragment per tile scans its pixels
+void MotionBlurTiles::draw_tile_max(GLuint velocityTexture, const std::function<void()>& drawQuad) const {
+    draw_tile_pass(tileMaxProgram, velocityTexture, drawQuad);
+}
+
+// 2. neighbour max over 3x3 tiles
+void MotionBlurTiles::draw_neighbor_max(GLuint tileMaxTexture, const std::function<void()>& drawQuad) const {
+    draw_tile_pass(neighborMaxProgram, tileMaxTexture, drawQuad);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+
+#include <GL/glew.h>
+
+#include "core/render/render_target.h"
+#include "core/render/shader_program.h"
+
+// Simple: the original fixed 4-tap blur along each pixel's own velocity.
+// Reconstruction: McGuire-style gather along the tile neighbourhood's max velocity.
+enum class MotionBlurMode { Off, Simple, Reconstruction };
+constexpr int MOTION_BLUR_MODE_COUNT = 3;
+
+const char* motion_blur_mode_name(MotionBlurMode mode);
+
+// Velocity prepasses for the reconstruction filter. The scene velocity buffer is reduced
+// to the largest vector of each TILE_SIZE² tile, then to the largest of every 3x3 tile
+// neighbourhood. blur.frag reads the neighbour max to choose direction and sample count,
+// and returns early for tiles where nothing moves. The tile targets belong to the caller
+// (see target_desc()); this class only owns the two programs.
+class MotionBlurTiles {
+private:
+    ShaderProgram tileMaxProgram;
+    ShaderProgram neighborMaxProgram;
+
+public:
+    static constexpr int TILE_SIZE = 16;   // also the max blur radius in pixels
+
+    MotionBlurTiles() = default;
+
+    MotionBlurTiles(const MotionBlurTiles&) = delete;
+    MotionBlurTiles& operator=(const MotionBlurTiles&) = delete;
+
+    bool init();
+
+    // RG16F, one texel per tile of a velocity buffer rendered at sceneScale
+    static RenderTargetDesc target_desc(float sceneScale = 1.0f);
+
+    // Each pass draws drawQuad (a full-screen quad using blur.vert's layout) into the
+    // currently bound tile-sized target.
+    void draw_tile_max(GLuint velocityTexture, const std::function<void()>& drawQuad) const;
+    void draw_neighbor_max(GLuint tileMaxTexture, const std::function<void()>& drawQuad) const;
+};
@@ -0,0 +1,142 @@
+#include "core/render/obj_file.h"
+
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+struct FaceVertex {
+    int position = 0;
+    int normal = 0;
+    int texcoord = 0;
+};
+
+void parse_face_token(const std::string& token, FaceVertex& fv) {
+    // OBJ indices are 1-based, negative values refer from the end.
+    int v = 0, vt = 0, vn = 0;
+    size_t firstSlash = token.find('/');
+    if (firstSlash == std::string::npos) {
+        v = std::stoi(token);
+    } else {
+        size_t secondSlash = token.find('/', firstSlash + 1);
+        v = std::stoi(token.substr(0, firstSlash));
+        if (secondSlash == std::string::npos) {
+            if (firstSlash + 1 < token.size())
+                vt = std::stoi(token.substr(firstSlash + 1));
+        } else {
+            if (secondSlash > firstSlash + 1)
+                vt = std::stoi(token.substr(firstSlash + 1, secondSlash - firstSlash - 1));
+            if (secondSlash + 1 < token.size())
+                vn = std::stoi(token.substr(secondSlash + 1));
+        }
+    }
+
+    fv.position = v;
+    fv.normal = vn;
+    fv.texcoord = vt;
+}
+
+void generate_flat_normals(TriangleSoup& soup) {
+    const std::vector<float>& p = soup.positions;
+    soup.normals.assign(p.size(), 0.0f);
+    for (size_t i = 0; i + 8 < p.size(); i += 9) {
+        float ux = p[i + 3] - p[i], uy = p[i + 4] - p[i + 1], uz = p[i + 5] - p[i + 2];
+        float vx = p[i + 6] - p[i], vy = p[i + 7] - p[i + 1], vz = p[i + 8] - p[i + 2];
+
+        float nx = uy * vz - uz * vy;
+        float ny = uz * vx - ux * vz;
+        float nz = ux * vy - uy * vx;
+        float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (length <= 0.0f)
+            length = 1.0f;
+
+        for (int v = 0; v < 3; ++v) {
+            size_t base = i + v * 3;
+            soup.normals[base] = nx / length;
+            soup.normals[base + 1] = ny / length;
+            soup.normals[base + 2] = nz / length;
+        }
+    }
+}
+}
+
+bool read_obj(const std::string& path, TriangleSoup& out) {
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    out = TriangleSoup{};
+    std::vector<std::array<float, 3>> tempPositions;
+    std::vector<std::array<float, 3>> tempNormals;
+    std::vector<std::array<float, 2>> tempTexcoords;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream iss(line);
+        std::string prefix;
+        iss >> prefix;
+
+        if (prefix == "v") {
+            float x, y, z;
+            iss >> x >> y >> z;
+            tempPositions.push_back({x, y, z});
+        } else if (prefix == "vn") {
+            float x, y, z;
+            iss >> x >> y >> z;
+            tempNormals.push_back({x, y, z});
+        } else if (prefix == "vt") {
+            float u, v;
+            iss >> u >> v;
+            tempTexcoords.push_back({u, v});
+        } else if (prefix == "f") {
+            std::vector<FaceVertex> faceVertices;
+            std::string token;
+            while (iss >> token) {
+                FaceVertex fv{};
+                parse_face_token(token, fv);
+                faceVertices.push_back(fv);
+            }
+
+            if (faceVertices.size() < 3)
+                continue;
+
+            auto resolve_index = [&](int idx, const auto& container) -> const auto& {
+                if (idx > 0)
+                    return container[static_cast<size_t>(idx - 1)];
+                // Negative indices refer to relative positions from end
+                return container[static_cast<size_t>(container.size() + idx)];
+            };
+
+            for (size_t i = 1; i + 1 < faceVertices.size(); ++i) {
+                FaceVertex tri[3] = {faceVertices[0], faceVertices[i], faceVertices[i + 1]};
+                for (const auto& vert : tri) {
+                    const auto& pos = resolve_index(vert.position, tempPositions);
+                    out.positions.insert(out.positions.end(), {pos[0], pos[1], pos[2]});
+                    if (!tempNormals.empty() && vert.normal != 0) {
+                        const auto& nor = resolve_index(vert.normal, tempNormals);
+                        out.normals.insert(out.normals.end(), {nor[0], nor[1], nor[2]});
+                    }
+                    if (!tempTexcoords.empty() && vert.texcoord != 0) {
+                        const auto& uv = resolve_index(vert.texcoord, tempTexcoords);
+                        out.texcoords.insert(out.texcoords.end(), {uv[0], uv[1]});
+                    }
+                }
+            }
+        }
+    }
+
+    if (out.positions.empty())
+        return false;
+
+    // Generate flat normals if the OBJ did not provide any usable ones
+    if (out.normals.size() != out.positions.size())
+        generate_flat_normals(out);
+    // Drop partial uvs to keep the streams aligned
+    if (out.texcoords.size() != (out.positions.size() / 3) * 2)
+        out.texcoords.clear();
+    return true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Non-indexed triangle list as read from an OBJ: xyz per corner, uv optional (empty).
+struct TriangleSoup {
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> texcoords;
+
+    size_t triangle_count() const { return positions.size() / 9; }
+};
+
+// Parse an OBJ without touching GL. Polygons are fanned into triangles, flat normals
+// fill in when the file has no usable ones, and partial uvs are dropped.
+bool read_obj(const std::string& path, TriangleSoup& out);
@@ -0,0 +1,302 @@
+#include "core/render/render_graph.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include "core/base/profiler.h"
+
+void RenderGraph::resize(int windowWidth, int windowHeight) {
+    width = std::max(windowWidth, 1);
+    height = std::max(windowHeight, 1);
+    for (auto& entry : pool)
+        if (entry.allocated)
+            entry.target.resize(width, height);
+    for (auto& [name, entry] : persistentTargets)
+        if (entry.allocated)
+            entry.target.resize(width, height);
+}
+
+void RenderGraph::release() {
+    for (auto& entry : pool)
+        if (entry.allocated)
+            entry.target.release();
+    pool.clear();
+    for (auto& [name, entry] : persistentTargets)
+        if (entry.allocated)
+            entry.target.release();
+    persistentTargets.clear();
+    reset();
+}
+
+void RenderGraph::reset() {
+    resources.clear();
+    passes.clear();
+    presented = RG_NONE;
+    presentDirect = false;
+}
+
+RGResource RenderGraph::create(const char* name, const RenderTargetDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resources.push_back(std::move(resource));
+    return static_cast<RGResource>(resources.size() - 1);
+}
+
+RGResource RenderGraph::import(const char* name, GLuint texture) {
+    Resource resource;
+    resource.name = name;
+    resource.imported = texture;
+    resources.push_back(std::move(resource));
+    return static_cast<RGResource>(resources.size() - 1);
+}
+
+RGResource RenderGraph::persistent(const char* name, const RenderTargetDesc& desc) {
+    auto it = persistentTargets.find(name);
+    if (it == persistentTargets.end())
+        it = persistentTargets.try_emplace(name).first;
+    PooledTarget& entry = it->second;
+    if (entry.allocated && !same_layout(entry.target.get_desc(), desc)) {
+        entry.target.release();
+        entry.allocated = false;
+    }
+    if (!entry.allocated) {
+        entry.target.init(desc, width, height);
+        entry.allocated = true;
+    }
+    entry.used = true;
+
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.persistent = &entry.target;
+    resources.push_back(std::move(resource));
+    return static_cast<RGResource>(resources.size() - 1);
+}
+
+void RenderGraph::add_pass(const char* name, std::initializer_list<RGResource> reads, RGResource output,
+                           std::function<void()> execute) {
+    if (output < 0 || output >= static_cast<RGResource>(resources.size())) {
+        std::cerr << "[RenderGraph] Pass '" << name << "' has no valid output, ignored\n";
+        return;
+    }
+
+    Pass pass;
+    pass.name = name;
+    pass.reads.reserve(reads.size());
+    // RG_NONE reads come from optional producers that are off this frame
+    for (RGResource read : reads)
+        if (read != RG_NONE)
+            pass.reads.push_back(read);
+    pass.output = output;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+}
+
+void RenderGraph::present(RGResource resource) {
+    presented = resource;
+}
+
+// Passes are declared in dependency order, so one backwards sweep finds every
+// pass that (transitively) feeds the presented resource.
+void RenderGraph::cull() {
+    FrameVector<bool> needed(resources.size(), false);
+    if (presented != RG_NONE)
+        needed[presented] = true;
+
+    culledPasses = 0;
+    for (auto it = passes.rbegin(); it != passes.rend(); ++it) {
+        it->culled = !needed[it->output];
+        if (it->culled) {
+            ++culledPasses;
+            continue;
+        }
+        for (RGResource read : it->reads)
+            needed[read] = true;
+    }
+}
+
+void RenderGraph::assign_targets() {
+    int passCount = static_cast<int>(passes.size());
+    for (int i = 0; i < passCount; ++i) {
+        const Pass& pass = passes[i];
+        if (pass.culled)
+            continue;
+        Resource& output = resources[pass.output];
+        if (output.firstUse < 0)
+            output.firstUse = i;
+        output.lastUse = std::max(output.lastUse, i);
+        for (RGResource read : pass.reads)
+            resources[read].lastUse = std::max(resources[read].lastUse, i);
+    }
+    if (presented != RG_NONE)
+        resources[presented].lastUse = passCount;   // read by the final blit
+
+    // Full-size single-colour output nobody samples: render it on the screen directly.
+    // The window has its own depth buffer, and an unsampled depth attachment needs nothing more.
+    if (presented != RG_NONE) {
+        const Resource& out = resources[presented];
+        bool sampled = false;
+        for (const auto& pass : passes)
+            if (!pass.culled && std::find(pass.reads.begin(), pass.reads.end(), presented) != pass.reads.end())
+                sampled = true;
+        presentDirect = !out.imported && !out.persistent && !sampled && out.desc.color.size() == 1
+                        && out.desc.scale == 1.0f && out.desc.divisor == 1;
+    }
+
+    for (auto& entry : pool)
+        entry.busy = entry.used = false;
+
+    // Walk the live passes in order: a target returns to the pool after its last
+    // reader, so a later transient target with the same layout reuses its memory.
+    FrameVector<bool> returned(resources.size(), false);
+    for (int i = 0; i < passCount; ++i) {
+        const Pass& pass = passes[i];
+        if (pass.culled)
+            continue;
+        for (size_t r = 0; r < resources.size(); ++r) {
+            if (resources[r].slot >= 0 && !returned[r] && resources[r].lastUse < i) {
+                pool[resources[r].slot].busy = false;
+                returned[r] = true;
+            }
+        }
+        Resource& output = resources[pass.output];
+        bool onScreen = pass.output == presented && presentDirect;
+        if (!output.imported && !output.persistent && !onScreen && output.slot < 0)
+            output.slot = acquire(output.desc);
+        // persistent targets may legitimately be read before this frame writes them
+        for (RGResource read : pass.reads)
+            if (!resources[read].imported && !resources[read].persistent && resources[read].firstUse < 0)
+                std::cerr << "[RenderGraph] '" << pass.name << "' reads '" << resources[read].name
+                          << "' before any pass writes it\n";
+    }
+}
+
+int RenderGraph::acquire(const RenderTargetDesc& desc) {
+    int freeSlot = -1;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        PooledTarget& entry = pool[i];
+        if (entry.busy)
+            continue;
+        if (entry.allocated && same_layout(entry.target.get_desc(), desc)) {
+            entry.busy = entry.used = true;
+            return static_cast<int>(i);
+        }
+        if (!entry.allocated && freeSlot < 0)
+            freeSlot = static_cast<int>(i);
+    }
+    if (freeSlot < 0) {
+        pool.emplace_back();
+        freeSlot = static_cast<int>(pool.size() - 1);
+    }
+    PooledTarget& entry = pool[freeSlot];
+    entry.target.init(desc, width, height);
+    entry.allocated = true;
+    entry.busy = entry.used = true;
+    return freeSlot;
+}
+
+void RenderGraph::bind_output(const Pass& pass) const {
+    const Resource& output = resources[pass.output];
+    if (output.imported)
+        return;
+    if (output.persistent) {
+        output.persistent->bind();
+        return;
+    }
+    if (output.slot >= 0) {
+        pool[output.slot].target.bind();
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+}
+
+void RenderGraph::execute() {
+    cull();
+    assign_targets();
+
+    for (const auto& pass : passes) {
+        if (pass.culled)
+            continue;
+        ProfileScope zone(pass.name);
+        bind_output(pass);
+        pass.execute();
+    }
+
+    if (presented != RG_NONE && !presentDirect) {
+        const Resource& out = resources[presented];
+        if (out.persistent)
+            out.persistent->blit_to_screen(width, height);
+        else if (out.slot >= 0)
+            pool[out.slot].target.blit_to_screen(width, height);
+        else
+            std::cerr << "[RenderGraph] Cannot present imported resource '" << out.name << "'\n";
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+
+    // Targets nobody used for a while (e.g. after switching an effect off) give their memory back.
+    for (auto& entry : pool) {
+        if (!entry.allocated)
+            continue;
+        entry.idleFrames = entry.used ? 0 : entry.idleFrames + 1;
+        if (entry.idleFrames > POOL_IDLE_FRAMES) {
+            entry.target.release();
+            entry.allocated = false;
+        }
+    }
+    for (auto& [name, entry] : persistentTargets) {
+        if (!entry.allocated)
+            continue;
+        entry.idleFrames = entry.used ? 0 : entry.idleFrames + 1;
+        entry.used = false;
+        if (entry.idleFrames > POOL_IDLE_FRAMES) {
+            entry.target.release();
+            entry.allocated = false;
+        }
+    }
+}
+
+GLuint RenderGraph::texture(RGResource resource, size_t attachment) const {
+    if (resource < 0 || resource >= static_cast<RGResource>(resources.size()))
+        return 0;
+    const Resource& r = resources[resource];
+    if (r.imported)
+        return r.imported;
+    if (r.persistent)
+        return r.persistent->color(attachment);
+    return r.slot >= 0 ? pool[r.slot].target.color(attachment) : 0;
+}
+
+GLuint RenderGraph::depth_texture(RGResource resource) const {
+    if (resource < 0 || resource >= static_cast<RGResource>(resources.size()))
+        return 0;
+    const Resource& r = resources[resource];
+    if (r.persistent)
+        return r.persistent->depth();
+    return r.slot >= 0 ? pool[r.slot].target.depth() : 0;
+}
+
+int RenderGraph::pooled_count() const {
+    int count = 0;
+    for (const auto& entry : pool)
+        if (entry.allocated)
+            ++count;
+    for (const auto& [name, entry] : persistentTargets)
+        if (entry.allocated)
+            ++count;
+    return count;
+}
+
+size_t RenderGraph::pooled_bytes() const {
+    size_t bytes = 0;
+    for (const auto& entry : pool)
+        if (entry.allocated)
+            bytes += entry.target.byte_size();
+    for (const auto& [name, entry] : persistentTargets)
+        if (entry.allocated)
+            bytes += entry.target.byte_size();
+    return bytes;
+}
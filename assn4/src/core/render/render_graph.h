@@ -0,0 +1,110 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "core/base/frame_arena.h"
+#include "core/render/render_target.h"
+
+// Index of a resource declared for the current frame; -1 = none.
+using RGResource = int;
+constexpr RGResource RG_NONE = -1;
+
+// Per-frame pass list. Every frame the caller re-declares its passes, each with the
+// resources it reads and the one it writes, then calls execute():
+// - passes that do not contribute to the presented resource are culled,
+// - transient targets are taken from a pool; targets whose lifetimes do not overlap
+//   and whose layouts match share one allocation,
+// - a single-colour, full-size presented target is rendered straight to the screen
+//   (its depth, if any, becomes the window's depth buffer); anything else is blitted
+//   there after the last pass.
+// Persistent targets (e.g. a temporal history) keep their contents between frames and
+// are never aliased. Pooled and persistent targets follow the window through resize(),
+// the only resize entry point.
+// Declaring a frame does not allocate once the containers have grown: names are kept by
+// pointer (pass string literals), reads live in the frame arena, and execute callbacks
+// should capture no more than std::function stores inline (16 bytes in libstdc++).
+class RenderGraph {
+private:
+    static constexpr int POOL_IDLE_FRAMES = 120;   // unused this long → GL memory is freed
+
+    struct Resource {
+        const char* name = "";
+        RenderTargetDesc desc;
+        GLuint imported = 0;   // external texture (e.g. the shadow map); 0 for transient targets
+        RenderTarget* persistent = nullptr;
+        int firstUse = -1;     // pass indices, live passes only
+        int lastUse = -1;
+        int slot = -1;         // pool entry; -1 = imported or the screen
+    };
+    struct Pass {
+        const char* name = "";
+        FrameVector<RGResource> reads;
+        RGResource output;
+        std::function<void()> execute;
+        bool culled = false;
+    };
+    struct PooledTarget {
+        RenderTarget target;
+        bool allocated = false;
+        bool busy = false;     // holds a live resource at the current point of the frame
+        bool used = false;     // held by any resource this frame
+        int idleFrames = 0;
+    };
+
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+    std::deque<PooledTarget> pool;   // deque: entries never move, RenderTarget is not movable
+    std::map<std::string, PooledTarget, std::less<>> persistentTargets;   // found without a key string
+    RGResource presented = RG_NONE;
+    bool presentDirect = false;
+    int width = 1;
+    int height = 1;
+    int culledPasses = 0;
+
+    void cull();
+    void assign_targets();
+    int acquire(const RenderTargetDesc& desc);
+    void bind_output(const Pass& pass) const;
+
+public:
+    RenderGraph() = default;
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    void resize(int windowWidth, int windowHeight);
+    void release();
+
+    // Frame declaration; reset() drops the previous frame's passes and resources.
+    void reset();
+    RGResource create(const char* name, const RenderTargetDesc& desc);
+    RGResource import(const char* name, GLuint texture);
+    // Same name → same target every frame; reallocated only when the layout changes.
+    RGResource persistent(const char* name, const RenderTargetDesc& desc);
+    // The output is bound (FBO + viewport) before execute runs, unless it is imported,
+    // in which case the pass binds its own framebuffer.
+    void add_pass(const char* name, std::initializer_list<RGResource> reads, RGResource output,
+                  std::function<void()> execute);
+    void present(RGResource resource);
+
+    // Culls, assigns targets and runs the surviving passes in declaration order.
+    // Leaves the default framebuffer bound with the window viewport.
+    void execute();
+
+    // Valid inside a pass that declared the resource as a read.
+    GLuint texture(RGResource resource, size_t attachment = 0) const;
+    GLuint depth_texture(RGResource resource) const;
+
+    int pass_count() const { return static_cast<int>(passes.size()); }
+    int culled_count() const { return culledPasses; }
+    // Pooled and persistent targets holding GL memory
+    int pooled_count() const;
+    size_t pooled_bytes() const;
+};
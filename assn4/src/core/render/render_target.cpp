@@ -0,0 +1,152 @@
+#include "core/render/render_target.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// Bytes per texel of the formats used for render targets
+size_t texel_size(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_RGBA16F: return 8;
+    case GL_RG16F:
+    case GL_RGBA8:
+    case GL_DEPTH_COMPONENT24: return 4;
+    case GL_RG8:
+    case GL_RG8_SNORM:
+    case GL_R16F: return 2;
+    default: return 4;
+    }
+}
+
+GLenum base_format(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_RG16F:
+    case GL_RG8:
+    case GL_RG8_SNORM: return GL_RG;
+    case GL_R16F: return GL_RED;
+    default: return GL_RGBA;
+    }
+}
+
+GLuint create_texture(GLenum internalFormat, GLenum format, GLenum type, GLenum filter, int width, int height) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+}
+
+int RenderTargetDesc::scaled(int windowSize) const {
+    int size = std::max(1, static_cast<int>(std::lround(static_cast<float>(windowSize) * scale)));
+    int div = std::max(divisor, 1);
+    return (size + div - 1) / div;
+}
+
+bool same_layout(const RenderTargetDesc& a, const RenderTargetDesc& b) {
+    if (a.depth != b.depth || a.scale != b.scale || a.divisor != b.divisor || a.color.size() != b.color.size())
+        return false;
+    for (size_t i = 0; i < a.color.size(); ++i)
+        if (a.color[i].internalFormat != b.color[i].internalFormat || a.color[i].filter != b.color[i].filter)
+            return false;
+    return true;
+}
+
+bool RenderTarget::init(const RenderTargetDesc& targetDesc, int windowWidth, int windowHeight) {
+    desc = targetDesc;
+    width = desc.scaled(windowWidth);
+    height = desc.scaled(windowHeight);
+    glGenFramebuffers(1, &fbo);
+    allocate();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete)
+        std::cerr << "ERROR::FRAMEBUFFER:: Render target is not complete!" << std::endl;
+    return complete;
+}
+
+void RenderTarget::resize(int windowWidth, int windowHeight) {
+    int w = desc.scaled(windowWidth);
+    int h = desc.scaled(windowHeight);
+    if (!fbo || (w == width && h == height))
+        return;
+    width = w;
+    height = h;
+    allocate();
+}
+
+void RenderTarget::allocate() {
+    release_textures();
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < desc.color.size(); ++i) {
+        const auto& attachment = desc.color[i];
+        GLuint texture = create_texture(attachment.internalFormat, base_format(attachment.internalFormat),
+                                        GL_FLOAT, attachment.filter, width, height);
+        GLenum slot = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, slot, GL_TEXTURE_2D, texture, 0);
+        colorTextures.push_back(texture);
+        drawBuffers.push_back(slot);
+    }
+    if (desc.depth) {
+        depthTexture = create_texture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, GL_NEAREST, width, height);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (drawBuffers.empty())
+        glDrawBuffer(GL_NONE);
+    else
+        glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::FRAMEBUFFER:: Render target resize failed!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderTarget::release_textures() {
+    if (!colorTextures.empty())
+        glDeleteTextures(static_cast<GLsizei>(colorTextures.size()), colorTextures.data());
+    colorTextures.clear();
+    if (depthTexture)
+        glDeleteTextures(1, &depthTexture);
+    depthTexture = 0;
+}
+
+void RenderTarget::release() {
+    release_textures();
+    if (fbo)
+        glDeleteFramebuffers(1, &fbo);
+    fbo = 0;
+}
+
+void RenderTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+}
+
+void RenderTarget::blit_to_screen(int windowWidth, int windowHeight) const {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+size_t RenderTarget::byte_size() const {
+    size_t texels = static_cast<size_t>(width) * height;
+    size_t bytes = 0;
+    for (const auto& attachment : desc.color)
+        bytes += texels * texel_size(attachment.internalFormat);
+    if (desc.depth)
+        bytes += texels * texel_size(GL_DEPTH_COMPONENT24);
+    return bytes;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+#include <vector>
+
+#include <GL/glew.h>
+
+struct ColorAttachmentDesc {
+    GLenum internalFormat = GL_RGBA8;
+    GLenum filter = GL_LINEAR;
+};
+
+constexpr size_t MAX_COLOR_ATTACHMENTS = 4;
+
+// Fixed-capacity attachment list: descs are copied into the render graph every frame,
+// and copying this never allocates.
+class ColorAttachments {
+private:
+    std::array<ColorAttachmentDesc, MAX_COLOR_ATTACHMENTS> items{};
+    size_t count = 0;
+
+public:
+    ColorAttachments() = default;
+    // Attachments beyond MAX_COLOR_ATTACHMENTS are dropped.
+    ColorAttachments(std::initializer_list<ColorAttachmentDesc> list) {
+        for (const auto& attachment : list)
+            if (count < MAX_COLOR_ATTACHMENTS)
+                items[count++] = attachment;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const ColorAttachmentDesc& operator[](size_t i) const { return items[i]; }
+    const ColorAttachmentDesc* begin() const { return items.data(); }
+    const ColorAttachmentDesc* end() const { return items.data() + count; }
+};
+
+// Attachments of an off-screen target; the size follows the window times `scale`,
+// divided (rounding up) by `divisor` for per-tile targets.
+struct RenderTargetDesc {
+    ColorAttachments color;
+    bool depth = false;      // GL_DEPTH_COMPONENT24 texture, so later passes can sample it
+    float scale = 1.0f;
+    int divisor = 1;
+
+    // Target width/height for a window dimension
+    int scaled(int windowSize) const;
+};
+
+// Same attachments at the same relative size, i.e. interchangeable targets.
+bool same_layout(const RenderTargetDesc& a, const RenderTargetDesc& b);
+
+// Framebuffer plus its textures. All allocation and resize logic for off-screen
+// targets lives here instead of in per-target init/resize functions.
+class RenderTarget {
+private:
+    RenderTargetDesc desc;
+    GLuint fbo = 0;
+    std::vector<GLuint> colorTextures;
+    GLuint depthTexture = 0;
+    int width = 0;
+    int height = 0;
+
+    void allocate();
+    void release_textures();
+
+public:
+    RenderTarget() = default;
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    bool init(const RenderTargetDesc& targetDesc, int windowWidth, int windowHeight);
+    // Reallocates only when the scaled size changes.
+    void resize(int windowWidth, int windowHeight);
+    void release();
+
+    // Binds the FBO with every colour attachment as a draw buffer and sets the viewport.
+    void bind() const;
+    // Linear-filtered copy of colour attachment 0 onto the default framebuffer.
+    void blit_to_screen(int windowWidth, int windowHeight) const;
+
+    GLuint color(size_t index) const { return index < colorTextures.size() ? colorTextures[index] : 0; }
+    GLuint depth() const { return depthTexture; }
+    const RenderTargetDesc& get_desc() const { return desc; }
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+    size_t byte_size() const;
+};
@@ -1,14 +1,17 @@
 #include "core/render/renderer.h"
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 
+#include "core/render/asset_registry.h"
+#include "core/render/material.h"
 #include "core/render/mesh.h"
 #include "core/render/texture.h"
-#include "core/globals/game_constants.h"
 
 namespace {
     struct GLRenderState {
@@ -52,16 +55,55 @@ namespace {
         glPolygonOffset(state.polygonOffsetFactor, state.polygonOffsetUnits);
     }
 
+    // Depth pre-pass followed by an offset outline pass.
+    template <typename DrawFn>
+    void draw_hidden_line(DrawFn&& draw) {
+        GLRenderState saved = capture_state();
+
+        glEnable(GL_DEPTH_TEST);
+        glDisable(GL_POLYGON_OFFSET_LINE);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_TRUE);
+        draw(); // depth pre-pass
+
+        glEnable(GL_POLYGON_OFFSET_LINE);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_FALSE);
+        glPolygonOffset(-1.0f, -1.0f);
+        glLineWidth(2.0f);
+        draw(); // outline pass
+
+        restore_state(saved);
+    }
+
+    // Matches uUseTexture in the surface shaders.
+    enum DiffuseMode { DIFFUSE_NONE = 0, DIFFUSE_2D = 1, DIFFUSE_ARRAY = 2, DIFFUSE_ATLAS = 3 };
+
     bool is_triangle_primitive(GLenum primitive) {
         return primitive == GL_TRIANGLES || primitive == GL_TRIANGLE_STRIP || primitive == GL_TRIANGLE_FAN;
     }
+
+    DrawData make_draw_data(const glm::mat4& model, const glm::mat4& prevModel, const glm::vec4& color,
+                            MaterialId material) {
+        DrawData data;
+        data.model = model;
+        data.prevModel = prevModel;
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+        for (int c = 0; c < 3; ++c)
+            data.normalMatrix[c] = glm::vec4(normalMatrix[c], 0.0f);
+        data.normalMatrix[0].w = static_cast<float>(material);
+        data.color = color;
+        return data;
+    }
 }
 
 bool Renderer::init() {
     // Load and cache shader programs per shading mode
-    auto load_set = [&](ShadingMode mode, const char* vert, const char* frag) -> bool {
-        auto& s = shaders[static_cast<int>(mode)];
-        bool loaded = s.program.load_from_files(vert, frag);
+    auto load_set = [&](int slot, const char* vert, const char* frag, const char* defines) -> bool {
+        auto& s = shaders[slot];
+        bool loaded = s.program.load_from_files(vert, frag, defines);
         if (!loaded)
             return false;
 
@@ -93,6 +135,9 @@ bool Renderer::init() {
         s.uViewPos              = s.program.uniform_location("uViewPos");
         s.uUseTexture           = s.program.uniform_location("uUseTexture");
         s.uDiffuseMap           = s.program.uniform_location("uDiffuseMap");
+        s.uDiffuseArray         = s.program.uniform_location("uDiffuseArray");
+        s.uDiffuseLayer         = s.program.uniform_location("uDiffuseLayer");
+        s.uDiffuseRect          = s.program.uniform_location("uDiffuseRect");
         s.uUseNormalMap         = s.program.uniform_location("uUseNormalMap");
         s.uNormalMap            = s.program.uniform_location("uNormalMap");
 
@@ -100,33 +145,82 @@ bool Renderer::init() {
         s.uLightSpaceMatrix     = s.program.uniform_location("uLightSpaceMatrix");
         s.uShadowMap            = s.program.uniform_location("uShadowMap");
         s.uUseShadow            = s.program.uniform_location("uUseShadow");
+        s.uCascadeCount         = s.program.uniform_location("uCascadeCount");
+        s.uShadowTaps           = s.program.uniform_location("uShadowTaps");
+        s.uShadowFilterRadius   = s.program.uniform_location("uShadowFilterRadius");
+        s.uShadowBias           = s.program.uniform_location("uShadowBias");
+        s.uCascadeLightSpace.fill(-1);
+        s.uCascadeSplits.fill(-1);
+        for (int i = 0; i < MAX_SHADOW_CASCADES; ++i) {
+            std::string idx = std::to_string(i);
+            s.uCascadeLightSpace[i] = s.program.uniform_location(("uCascadeLightSpace[" + idx + "]").c_str());
+            s.uCascadeSplits[i]     = s.program.uniform_location(("uCascadeSplits[" + idx + "]").c_str());
+        }
 
         // related to motion blur
         s.colorTexture         = s.program.uniform_location("colorTexture");
         s.velocityTexture       = s.program.uniform_location("velocityTexture");
+        s.depthTexture          = s.program.uniform_location("depthTexture");
+        s.neighborMaxTexture    = s.program.uniform_location("neighborMaxTexture");
+        s.uTileSize             = s.program.uniform_location("uTileSize");
+        s.uDepthParams          = s.program.uniform_location("uDepthParams");
         s.uPrevModel            = s.program.uniform_location("uPrevModel");
         s.uPrevView             = s.program.uniform_location("uPrevView");
         s.uPrevProj             = s.program.uniform_location("uPrevProj");
         s.useVelocity           = s.program.uniform_location("useVelocity");
+        s.uDrawData             = s.program.uniform_location("uDrawData");
 
         if (s.colorTexture >= 0) glUniform1i(s.colorTexture, 0);
         if (s.velocityTexture >= 0) glUniform1i(s.velocityTexture, 1);
+        if (s.depthTexture >= 0) glUniform1i(s.depthTexture, 2);
+        if (s.neighborMaxTexture >= 0) glUniform1i(s.neighborMaxTexture, 3);
+        if (s.uTileSize >= 0) glUniform1i(s.uTileSize, MotionBlurTiles::TILE_SIZE);
         if (s.uDiffuseMap >= 0) glUniform1i(s.uDiffuseMap, 0);
+        if (s.uDiffuseArray >= 0) glUniform1i(s.uDiffuseArray, 3);
         if (s.uNormalMap >= 0) glUniform1i(s.uNormalMap, 1);
+        if (s.uShadowMap >= 0) glUniform1i(s.uShadowMap, 2);
+        if (s.uDrawData >= 0) glUniform1i(s.uDrawData, DRAW_DATA_UNIT);
 
         s.program.unbind();
 
-        return (s.uModel >= 0 && s.uView >= 0 && s.uProj >= 0 && s.uColor >= 0 && s.uNormal >= 0 && s.uLighting >= 0)
+        bool perDraw = (s.uModel >= 0 && s.uColor >= 0 && s.uNormal >= 0) || s.uDrawData >= 0;
+        return (perDraw && s.uView >= 0 && s.uProj >= 0 && s.uLighting >= 0)
         || (s.uModel >= 0 && s.uLightSpaceMatrix >= 0)
         || (s.colorTexture >= 0 && s.velocityTexture >= 0);
     };
 
+    const char* litShaders[LIT_SHADING_MODES][2] = {
+        {"core/render/shaders/gouraud.vert", "core/render/shaders/gouraud.frag"},
+        {"core/render/shaders/phong.vert", "core/render/shaders/phong.frag"},
+        {"core/render/shaders/phong_nm.vert", "core/render/shaders/phong_nm.frag"},
+    };
     bool is_valid = true;
-    is_valid &= load_set(ShadingMode::Gouraud, "core/render/shaders/gouraud.vert", "core/render/shaders/gouraud.frag");
-    is_valid &= load_set(ShadingMode::Phong, "core/render/shaders/phong.vert", "core/render/shaders/phong.frag");
-    is_valid &= load_set(ShadingMode::PhongNormalMap, "core/render/shaders/phong_nm.vert", "core/render/shaders/phong_nm.frag");
-    is_valid &= load_set(ShadingMode::DepthOnly, "core/render/shaders/depth.vert", "core/render/shaders/depth.frag");
-    is_valid &= load_set(ShadingMode::MotionBlur, "core/render/shaders/blur.vert", "core/render/shaders/blur.frag");
+    for (int i = 0; i < LIT_SHADING_MODES; ++i) {
+        is_valid &= load_set(i, litShaders[i][0], litShaders[i][1], "");
+        is_valid &= load_set(SHADING_MODES + i, litShaders[i][0], litShaders[i][1], "#define NO_VELOCITY\n");
+    }
+    if (indirectDraws.init()) {
+        for (int i = 0; i < LIT_SHADING_MODES; ++i) {
+            is_valid &= load_set(SHADING_MODES + LIT_SHADING_MODES + i, litShaders[i][0], litShaders[i][1],
+                                 "#define INDIRECT\n");
+            is_valid &= load_set(SHADING_MODES + 2 * LIT_SHADING_MODES + i, litShaders[i][0], litShaders[i][1],
+                                 "#define INDIRECT\n#define NO_VELOCITY\n");
+        }
+    }
+    is_valid &= load_set(static_cast<int>(ShadingMode::DepthOnly), "core/render/shaders/depth.vert", "core/render/shaders/depth.frag", "");
+    is_valid &= load_set(static_cast<int>(ShadingMode::MotionBlur), "core/render/shaders/blur.vert", "core/render/shaders/blur.frag", "");
+
+    is_valid &= depthInstanced.load_from_files("core/render/shaders/depth_instanced.vert", "core/render/shaders/depth.frag");
+    uInstancedLightSpace = depthInstanced.uniform_location("uLightSpaceMatrix");
+    uInstancedModels = depthInstanced.uniform_location("uModels");
+    if (indirectDraws.ready()) {
+        is_valid &= depthIndirect.load_from_files("core/render/shaders/depth_instanced.vert",
+                                                  "core/render/shaders/depth.frag", "#define INDIRECT\n");
+        uIndirectLightSpace = depthIndirect.uniform_location("uLightSpaceMatrix");
+        depthIndirect.bind();
+        glUniform1i(depthIndirect.uniform_location("uDrawData"), DRAW_DATA_UNIT);
+        depthIndirect.unbind();
+    }
 
 
     if (!is_valid)
@@ -142,6 +236,7 @@ bool Renderer::init() {
     glBindTexture(GL_TEXTURE_2D, 0);
 
     currentShading = ShadingMode::Gouraud; // start with Gouraud -> W cycles Phong -> NormalMap
+    set_shadow_filter(ShadowFilter{});
     apply_render_style();
     return true;
 }
@@ -149,11 +244,10 @@ bool Renderer::init() {
 void Renderer::shutdown() {
     for (auto& s : shaders)
         s.program.unbind();
-    for (auto& kv : textureCache) {
-        if (kv.second.id)
-            glDeleteTextures(1, &kv.second.id);
-    }
-    textureCache.clear();
+    gMaterials.shutdown();
+    gAssets.shutdown();
+    indirectDraws.release();
+    gMeshBuffer.release();
     if (whiteTexture) {
         glDeleteTextures(1, &whiteTexture);
         whiteTexture = 0;
@@ -162,26 +256,43 @@ void Renderer::shutdown() {
 
 void Renderer::set_view(const glm::mat4& viewMatrix) {
     view = viewMatrix;
+    if (viewCut) {
+        prevView = view;
+        viewCut = false;
+    }
     for (auto& s : shaders) {
         s.program.bind();
         if (s.uView >= 0)
             glUniformMatrix4fv(s.uView, 1, GL_FALSE, &view[0][0]);
         if (s.uPrevView >= 0)
-            glUniformMatrix4fv(s.uPrevView, 1, GL_FALSE, &view[0][0]);
+            glUniformMatrix4fv(s.uPrevView, 1, GL_FALSE, &prevView[0][0]);
     }
-    shaders[static_cast<int>(currentShading)].program.bind(); // keep active shader bound
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
 }
 
 void Renderer::set_projection(const glm::mat4& projectionMatrix) {
     projection = projectionMatrix;
+    upload_projection();
+}
+
+void Renderer::set_projection_jitter(const glm::vec2& ndcOffset) {
+    if (ndcOffset == projectionJitter)
+        return;
+    projectionJitter = ndcOffset;
+    upload_projection();
+}
+
+// The previous-frame projection gets the same jitter, so velocity carries motion only.
+void Renderer::upload_projection() {
+    glm::mat4 jittered = glm::translate(glm::mat4(1.0f), glm::vec3(projectionJitter, 0.0f)) * projection;
     for (auto& s : shaders) {
         s.program.bind();
         if (s.uProj >= 0)
-            glUniformMatrix4fv(s.uProj, 1, GL_FALSE, &projection[0][0]);    
+            glUniformMatrix4fv(s.uProj, 1, GL_FALSE, &jittered[0][0]);
         if (s.uPrevProj >= 0 )
-            glUniformMatrix4fv(s.uPrevProj, 1, GL_FALSE, &projection[0][0]);
+            glUniformMatrix4fv(s.uPrevProj, 1, GL_FALSE, &jittered[0][0]);
     }
-    shaders[static_cast<int>(currentShading)].program.bind(); // keep active shader bound
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
 }
 
 void Renderer::set_view_position(const glm::vec3& pos) {
@@ -191,12 +302,12 @@ void Renderer::set_view_position(const glm::vec3& pos) {
         if (s.uViewPos >= 0)
             glUniform3fv(s.uViewPos, 1, &viewPos[0]);
     }
-    shaders[static_cast<int>(currentShading)].program.bind(); // keep active shader bound
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
 }
 
-void Renderer::set_lights(const DirectionalLight& dir, const std::vector<PointLight>& points) {
+void Renderer::set_lights(const DirectionalLight& dir, const PointLight* points, size_t count) {
     dirLight = dir;
-    pointLightCount = std::min(static_cast<int>(points.size()), MAX_POINT_LIGHTS);
+    pointLightCount = static_cast<int>(std::min(count, static_cast<size_t>(MAX_POINT_LIGHTS)));
     for (int i = 0; i < pointLightCount; ++i)
         pointLights[i] = points[i];
 
@@ -215,26 +326,57 @@ void Renderer::set_lights(const DirectionalLight& dir, const std::vector<PointLi
             if (s.uPointLightIntensity[i] >= 0) glUniform1f(s.uPointLightIntensity[i], pointLights[i].intensity);
         }
     }
-    shaders[static_cast<int>(currentShading)].program.bind(); // keep active shader bound
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
 }
 
-void Renderer::set_light_space_matrix() {
-    glm::mat4 lightProjection = glm::ortho(-MAX_COORD*2, MAX_COORD*2, -MAX_COORD*2, MAX_COORD*2, 1.0f, 100.0f);
-    glm::mat4 lightView = glm::lookAt(-dirLight.direction * 50.0f, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 mat = lightProjection * lightView;
-
+void Renderer::set_light_space_matrix(const glm::mat4& lightSpace) {
     for (auto& s : shaders) {
         s.program.bind();
         if (s.uLightSpaceMatrix >= 0)
-            glUniformMatrix4fv(s.uLightSpaceMatrix, 1, GL_FALSE, glm::value_ptr(mat));
+            glUniformMatrix4fv(s.uLightSpaceMatrix, 1, GL_FALSE, glm::value_ptr(lightSpace));
+    }
+    depthInstanced.bind();
+    if (uInstancedLightSpace >= 0)
+        glUniformMatrix4fv(uInstancedLightSpace, 1, GL_FALSE, glm::value_ptr(lightSpace));
+    if (uIndirectLightSpace >= 0) {
+        depthIndirect.bind();
+        glUniformMatrix4fv(uIndirectLightSpace, 1, GL_FALSE, glm::value_ptr(lightSpace));
     }
-    shaders[static_cast<int>(currentShading)].program.bind(); // keep active shader bound
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
 }
 
-void Renderer::set_shadow_map(GLuint depthMapTexture) {
+void Renderer::set_shadow_cascades(const ShadowCascades& cascades) {
+    for (auto& s : shaders) {
+        s.program.bind();
+        if (s.uCascadeCount >= 0)
+            glUniform1i(s.uCascadeCount, cascades.count);
+        for (int i = 0; i < cascades.count; ++i) {
+            if (s.uCascadeLightSpace[i] >= 0)
+                glUniformMatrix4fv(s.uCascadeLightSpace[i], 1, GL_FALSE, glm::value_ptr(cascades.lightSpace[i]));
+            if (s.uCascadeSplits[i] >= 0)
+                glUniform1f(s.uCascadeSplits[i], cascades.splitDepth[i]);
+        }
+    }
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
+}
+
+void Renderer::set_shadow_filter(const ShadowFilter& filter) {
+    for (auto& s : shaders) {
+        s.program.bind();
+        if (s.uShadowTaps >= 0)
+            glUniform1i(s.uShadowTaps, filter.taps);
+        if (s.uShadowFilterRadius >= 0)
+            glUniform1f(s.uShadowFilterRadius, filter.radius);
+        if (s.uShadowBias >= 0)
+            glUniform2f(s.uShadowBias, filter.constantBias, filter.slopeBias);
+    }
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
+}
+
+void Renderer::set_shadow_map(GLuint depthArrayTexture) {
     glActiveTexture(GL_TEXTURE2); 
-    glBindTexture(GL_TEXTURE_2D, depthMapTexture); 
-    if (depthMapTexture == 0) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArrayTexture); 
+    if (depthArrayTexture == 0) {
         // unbind shadow map
         for (auto& s : shaders) {
             s.program.bind();
@@ -252,25 +394,143 @@ void Renderer::set_shadow_map(GLuint depthMapTexture) {
         }
     }
 
-    shaders[static_cast<int>(currentShading)].program.bind(); // keep active shader bound
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
 }
 
-void Renderer::set_motion_blur(bool b) {
+void Renderer::set_motion_blur(MotionBlurMode mode) {
+    // Lets the resolve linearize scene depth without knowing near/far
+    glm::vec2 depthParams(projection[3][2], projection[2][2]);
     for (auto& s : shaders) {
         s.program.bind();
         if (s.useVelocity >= 0)
-            glUniform1i(s.useVelocity, b);
+            glUniform1i(s.useVelocity, static_cast<int>(mode));
+        if (s.uDepthParams >= 0)
+            glUniform2fv(s.uDepthParams, 1, glm::value_ptr(depthParams));
     }
-    shaders[static_cast<int>(currentShading)].program.bind(); // keep active shader bound
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
 }
 
 
 void Renderer::begin_frame() {
-    shaders[static_cast<int>(currentShading)].program.bind();
+    lastTrianglesSubmitted = trianglesSubmitted;
+    lastTrianglesFullDetail = trianglesFullDetail;
+    lastDrawCalls = drawCalls;
+    trianglesSubmitted = trianglesFullDetail = drawCalls = 0;
+    prevView = view;   // uploaded by this frame's set_view()
+    shaders[shader_slot(currentShading)].program.bind();
 }
 
 void Renderer::end_frame() {
-    shaders[static_cast<int>(currentShading)].program.unbind();
+    shaders[shader_slot(currentShading)].program.unbind();
+}
+
+// Lit variants after the base set: NO_VELOCITY, INDIRECT, INDIRECT + NO_VELOCITY.
+int Renderer::shader_slot(ShadingMode mode, bool indirect) const {
+    int index = static_cast<int>(mode);
+    if (index >= LIT_SHADING_MODES)
+        return index;
+    int variant = (velocityOutput ? 0 : 1) + (indirect ? 2 : 0);
+    return variant == 0 ? index : SHADING_MODES + (variant - 1) * LIT_SHADING_MODES + index;
+}
+
+// Projected diameter of the bounding sphere as a fraction of the screen height, from the
+// camera even in the shadow pass so casters match what is on screen.
+const Mesh& Renderer::select_lod(const Mesh& mesh, const glm::mat4& modelMatrix) {
+    trianglesFullDetail += mesh.triangle_count();
+    int level = 0;
+    if (lodBias > 0.0f && mesh.lod_count() > 1) {
+        float scale = std::max({glm::length(glm::vec3(modelMatrix[0])), glm::length(glm::vec3(modelMatrix[1])),
+                                glm::length(glm::vec3(modelMatrix[2]))});
+        glm::vec4 center = view * modelMatrix * glm::vec4(mesh.bounds_center(), 1.0f);
+        bool perspective = projection[2][3] != 0.0f;
+        float distance = perspective ? std::max(-center.z, 1e-3f) : 1.0f;
+        float size = mesh.bounds_radius() * scale * projection[1][1] / distance * lodBias;
+        if (size < LOD_FULL_DETAIL_SIZE)
+            level = size > 0.0f ? static_cast<int>(std::ceil(std::log2(LOD_FULL_DETAIL_SIZE / size))) : Mesh::MAX_LODS;
+    }
+    const Mesh& drawn = mesh.lod(level);
+    trianglesSubmitted += drawn.triangle_count();
+    return drawn;
+}
+
+const Renderer::ShaderHandles& Renderer::shader_for(const Mesh& mesh, bool indirect) const {
+    if (needs_fallback(mesh))
+        return shaders[shader_slot(ShadingMode::Phong, indirect)];
+    return shaders[shader_slot(currentShading, indirect)];
+}
+
+bool Renderer::needs_fallback(const Mesh& mesh) const {
+    return currentShading == ShadingMode::PhongNormalMap && (!mesh.has_texcoords() || !mesh.has_tangents());
+}
+
+void Renderer::bind_transform(const ShaderHandles& shader,
+                              const glm::mat4& modelMatrix,
+                              const glm::mat4& prevModelMatrix,
+                              const glm::vec4& color) const {
+    if (shader.uModel >= 0) glUniformMatrix4fv(shader.uModel, 1, GL_FALSE, &modelMatrix[0][0]);
+    if (shader.uPrevModel >= 0) glUniformMatrix4fv(shader.uPrevModel, 1, GL_FALSE, &prevModelMatrix[0][0]);
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
+    if (shader.uNormal >= 0) glUniformMatrix3fv(shader.uNormal, 1, GL_FALSE, &normalMatrix[0][0]);
+    if (shader.uColor >= 0) glUniform4fv(shader.uColor, 1, &color[0]);
+}
+
+void Renderer::bind_surface(const ShaderHandles& shader,
+                            bool lighting,
+                            GLuint diffuseTex,
+                            GLuint normalTex,
+                            bool useNormalMap) const {
+    if (shader.uLighting >= 0) glUniform1i(shader.uLighting, lighting ? 1 : 0);
+    bind_diffuse(shader, diffuseTex ? DIFFUSE_2D : DIFFUSE_NONE, diffuseTex);
+    bind_normal(shader, normalTex, useNormalMap);
+}
+
+void Renderer::bind_diffuse(const ShaderHandles& shader, int mode, GLuint texture) const {
+    if (shader.uUseTexture >= 0) glUniform1i(shader.uUseTexture, mode);
+    if (shader.uDiffuseMap >= 0) {
+        bool is2D = mode == DIFFUSE_2D || mode == DIFFUSE_ATLAS;
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, is2D ? texture : whiteTexture);
+    }
+    if (shader.uDiffuseArray >= 0) {
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, mode == DIFFUSE_ARRAY ? texture : 0);
+    }
+}
+
+void Renderer::bind_normal(const ShaderHandles& shader, GLuint normalTex, bool useNormalMap) const {
+    bool enableNormal = useNormalMap && normalTex != 0;
+    if (shader.uUseNormalMap >= 0) glUniform1i(shader.uUseNormalMap, enableNormal ? 1 : 0);
+    if (shader.uNormalMap >= 0) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, enableNormal ? normalTex : whiteTexture);
+    }
+}
+
+void Renderer::bind_material(const ShaderHandles& shader,
+                             const Material& mat,
+                             bool normalMap,
+                             bool rebindTextures) const {
+    const PackedTexture& packed = mat.packedDiffuse;
+    if (shader.uDiffuseLayer >= 0) glUniform1i(shader.uDiffuseLayer, packed.layer);
+    if (shader.uDiffuseRect >= 0) glUniform4fv(shader.uDiffuseRect, 1, &packed.rect[0]);
+    if (!rebindTextures)
+        return;
+
+    if (shader.uLighting >= 0) glUniform1i(shader.uLighting, mat.lighting ? 1 : 0);
+    if (packed.packed())
+        bind_diffuse(shader, packed.layer >= 0 ? DIFFUSE_ARRAY : DIFFUSE_ATLAS, packed.texture);
+    else if (mat.has(MATERIAL_DIFFUSE))
+        bind_diffuse(shader, DIFFUSE_2D, gAssets.texture(mat.diffuse));
+    else
+        bind_diffuse(shader, DIFFUSE_NONE, 0);
+    bind_normal(shader, normalMap ? gAssets.texture(mat.normal) : 0, normalMap);
+}
+
+void Renderer::draw_geometry(const Mesh& mesh) const {
+    if (currentStyle != RenderStyle::HiddenLineWireframe)
+        mesh.draw();
+    else
+        draw_hidden_line([&] { mesh.draw(); });
 }
 
 void Renderer::draw_mesh(const Mesh& mesh,
@@ -281,70 +541,200 @@ void Renderer::draw_mesh(const Mesh& mesh,
                          GLuint diffuseTex,
                          GLuint normalTex,
                          bool useNormalMap) const {
-    const ShaderHandles* shader = &shaders[static_cast<int>(currentShading)];
-    
     if (currentShading == ShadingMode::DepthOnly) {
-        shader->program.bind();
-        if (shader->uModel >= 0) glUniformMatrix4fv(shader->uModel, 1, GL_FALSE, &modelMatrix[0][0]);
+        const auto& shader = shaders[shader_slot(ShadingMode::DepthOnly)];
+        shader.program.bind();
+        if (shader.uModel >= 0) glUniformMatrix4fv(shader.uModel, 1, GL_FALSE, &modelMatrix[0][0]);
 
-        mesh.draw();
+        mesh.draw_positions();
+        glBindVertexArray(0);
         return;
     }
 
+    const ShaderHandles& shader = shader_for(mesh);
+    shader.program.bind();
+    bind_transform(shader, modelMatrix, prevModelMatrix, color);
+    bind_surface(shader, lighting, diffuseTex, normalTex, useNormalMap && !needs_fallback(mesh));
+    draw_geometry(mesh);
+    glBindVertexArray(0);
+}
 
-    bool needsFallback = currentShading == ShadingMode::PhongNormalMap &&
-                         (!mesh.has_texcoords() || !mesh.has_tangents());
-    if (needsFallback)
-        shader = &shaders[static_cast<int>(ShadingMode::Phong)];
+void Renderer::submit(const Mesh& mesh,
+                      const glm::mat4& modelMatrix,
+                      const glm::mat4& prevModelMatrix,
+                      MaterialId material,
+                      const glm::vec4& color) {
+    if (currentShading == ShadingMode::DepthOnly) {
+        submit_shadow(mesh, modelMatrix);
+        return;
+    }
 
-    shader->program.bind();
+    DrawItem item;
+    item.mesh = &select_lod(mesh, modelMatrix);
+    item.material = material;
+    item.order = static_cast<uint32_t>(drawQueue.size());
+    item.model = modelMatrix;
+    item.prevModel = prevModelMatrix;
+    item.color = gMaterials.get(material).tint * color;
+    item.transparent = item.color.a < 1.0f;
+    drawQueue.push_back(item);
+}
 
-    if (shader->uModel >= 0) glUniformMatrix4fv(shader->uModel, 1, GL_FALSE, &modelMatrix[0][0]);
-    if (shader->uPrevModel >= 0) glUniformMatrix4fv(shader->uPrevModel, 1, GL_FALSE, &prevModelMatrix[0][0]);
-    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
-    if (shader->uNormal >= 0) glUniformMatrix3fv(shader->uNormal, 1, GL_FALSE, &normalMatrix[0][0]);
-    if (shader->uColor >= 0) glUniform4fv(shader->uColor, 1, &color[0]);
-    if (shader->uLighting >= 0) glUniform1i(shader->uLighting, lighting ? 1 : 0);
+void Renderer::submit_shadow(const Mesh& mesh, const glm::mat4& modelMatrix) {
+    shadowQueue.push_back({&select_lod(mesh, modelMatrix), modelMatrix});
+}
 
+void Renderer::flush_shadows() {
+    // Anything queued before the switch to DepthOnly still has to land in the depth map.
+    for (const auto& item : drawQueue)
+        shadowQueue.push_back({item.mesh, item.model});
+    drawQueue.clear();
+    if (shadowQueue.empty())
+        return;
 
-    if (shader->uUseTexture >= 0) glUniform1i(shader->uUseTexture, diffuseTex ? 1 : 0);
-    if (shader->uDiffuseMap >= 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseTex ? diffuseTex : whiteTexture);
-        glUniform1i(shader->uDiffuseMap, 0);
+    // Same mesh back to back, so each pooled caster type becomes a few instanced draws.
+    std::sort(shadowQueue.begin(), shadowQueue.end(), [](const ShadowItem& a, const ShadowItem& b) {
+        return std::less<const Mesh*>()(a.mesh, b.mesh);
+    });
+
+    if (use_indirect(shadowQueue.size())) {
+        flush_shadows_indirect();
     }
+    else {
+        depthInstanced.bind();
+        std::array<glm::mat4, SHADOW_INSTANCES> models;
+        size_t i = 0;
+        while (i < shadowQueue.size()) {
+            const Mesh* mesh = shadowQueue[i].mesh;
+            GLsizei count = 0;
+            while (i < shadowQueue.size() && shadowQueue[i].mesh == mesh && count < SHADOW_INSTANCES)
+                models[count++] = shadowQueue[i++].model;
+            if (uInstancedModels >= 0)
+                glUniformMatrix4fv(uInstancedModels, count, GL_FALSE, glm::value_ptr(models[0]));
+            mesh->draw_positions(count);
+            ++drawCalls;
+        }
+    }
+    glBindVertexArray(0);
+    shadowQueue.clear();
+    shaders[shader_slot(currentShading)].program.bind(); // keep active shader bound
+}
 
-    bool enableNormal = useNormalMap && !needsFallback && normalTex != 0;
-    if (shader->uUseNormalMap >= 0) glUniform1i(shader->uUseNormalMap, enableNormal ? 1 : 0);
-    if (shader->uNormalMap >= 0) {
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, enableNormal ? normalTex : whiteTexture);
-        glUniform1i(shader->uNormalMap, 1);
+void Renderer::flush() {
+    if (currentShading == ShadingMode::DepthOnly) {
+        flush_shadows();
+        return;
     }
+    if (drawQueue.empty())
+        return;
 
-    if (currentStyle != RenderStyle::HiddenLineWireframe) {
-        mesh.draw();
+    // Opaque before transparent, then group by texture batch, material and mesh so state changes once per run.
+    std::sort(drawQueue.begin(), drawQueue.end(), [](const DrawItem& a, const DrawItem& b) {
+        if (a.transparent != b.transparent)
+            return !a.transparent;
+        uint32_t batchA = gMaterials.get(a.material).batch;
+        uint32_t batchB = gMaterials.get(b.material).batch;
+        if (batchA != batchB)
+            return batchA < batchB;
+        if (a.material != b.material)
+            return a.material < b.material;
+        if (a.mesh != b.mesh)
+            return std::less<const Mesh*>()(a.mesh, b.mesh);
+        return a.order < b.order;
+    });
+
+    if (use_indirect(drawQueue.size())) {
+        flush_indirect();
+        drawQueue.clear();
         return;
     }
 
-    GLRenderState saved = capture_state();
+    const ShaderHandles* boundShader = nullptr;
+    MaterialId boundMaterial = INVALID_MATERIAL;
+    uint32_t boundBatch = 0;
+    for (const auto& item : drawQueue) {
+        const ShaderHandles& shader = shader_for(*item.mesh);
+        if (&shader != boundShader || item.material != boundMaterial) {
+            const Material& mat = gMaterials.get(item.material);
+            bool normalMap = mat.has(MATERIAL_NORMAL_MAP) && !needs_fallback(*item.mesh);
+            bool rebind = &shader != boundShader || mat.batch != boundBatch;
+
+            shader.program.bind();
+            bind_material(shader, mat, normalMap, rebind);
+            boundShader = &shader;
+            boundMaterial = item.material;
+            boundBatch = mat.batch;
+        }
 
-    glEnable(GL_DEPTH_TEST);
-    glDisable(GL_POLYGON_OFFSET_LINE);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-    glDepthMask(GL_TRUE);
-    mesh.draw(); // depth pre-pass
+        bind_transform(shader, item.model, item.prevModel, item.color);
+        draw_geometry(*item.mesh);
+        drawCalls += currentStyle == RenderStyle::HiddenLineWireframe ? 2 : 1;
+    }
+    glBindVertexArray(0);   // every mesh draw above shared one VAO
+    drawQueue.clear();
+}
 
-    glEnable(GL_POLYGON_OFFSET_LINE);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-    glDepthMask(GL_FALSE);
-    glPolygonOffset(-1.0f, -1.0f);
-    glLineWidth(2.0f);
-    mesh.draw(); // outline pass
+bool Renderer::use_indirect(size_t drawCount) const {
+    return indirectOn && indirectDraws.ready() && drawCount <= indirectDraws.max_draws();
+}
+
+// Same order and state changes as the loop in flush(), but each shader/material run is a
+// single glMultiDrawElementsIndirect over commands built from the sorted queue.
+void Renderer::flush_indirect() {
+    indirectDraws.clear();
+    indirectBatches.clear();
+    for (const auto& item : drawQueue) {
+        const ShaderHandles& shader = shader_for(*item.mesh, true);
+        if (indirectBatches.empty() || indirectBatches.back().shader != &shader
+            || indirectBatches.back().material != item.material)
+            indirectBatches.push_back({&shader, item.material, item.mesh, indirectDraws.begin_batch()});
+        indirectDraws.add(item.mesh->range(), make_draw_data(item.model, item.prevModel, item.color, item.material));
+    }
+    indirectDraws.upload();
+    gMeshBuffer.bind();
+
+    const ShaderHandles* boundShader = nullptr;
+    uint32_t boundBatch = 0;
+    for (size_t b = 0; b < indirectBatches.size(); ++b) {
+        const IndirectBatch& batch = indirectBatches[b];
+        size_t end = b + 1 < indirectBatches.size() ? indirectBatches[b + 1].firstCommand : indirectDraws.command_count();
+        const Material& mat = gMaterials.get(batch.material);
+        bool normalMap = mat.has(MATERIAL_NORMAL_MAP) && !needs_fallback(*batch.mesh);
+        bool rebind = batch.shader != boundShader || mat.batch != boundBatch;
+
+        batch.shader->program.bind();
+        bind_material(*batch.shader, mat, normalMap, rebind);
+        boundShader = batch.shader;
+        boundBatch = mat.batch;
+
+        auto draw = [&] { indirectDraws.draw(batch.firstCommand, end - batch.firstCommand); };
+        if (currentStyle != RenderStyle::HiddenLineWireframe) {
+            draw();
+            ++drawCalls;
+        }
+        else {
+            draw_hidden_line(draw);
+            drawCalls += 2;
+        }
+    }
+    glBindVertexArray(0);
+}
+
+// The whole sorted shadow queue in one call: a command per mesh, its casters as instances.
+void Renderer::flush_shadows_indirect() {
+    indirectDraws.clear();
+    indirectDraws.begin_batch();
+    DrawData data{};
+    for (const auto& item : shadowQueue) {
+        data.model = item.model;
+        indirectDraws.add(item.mesh->range(), data);
+    }
+    indirectDraws.upload();
 
-    restore_state(saved);
+    depthIndirect.bind();
+    gMeshBuffer.bind_positions();
+    indirectDraws.draw(0, indirectDraws.command_count());
+    ++drawCalls;
 }
 
 void Renderer::draw_raw(GLuint vao,
@@ -355,68 +745,33 @@ void Renderer::draw_raw(GLuint vao,
                         bool lighting,
                         GLuint diffuseTex,
                         GLuint normalTex,
-                        bool useNormalMap) const {
-    const auto& shader = shaders[static_cast<int>(currentShading)];
+                        bool useNormalMap,
+                        GLint firstVertex) const {
+    const auto& shader = shaders[shader_slot(currentShading)];
 
     if (currentShading == ShadingMode::DepthOnly) {
         shader.program.bind();
         if (shader.uModel >= 0) glUniformMatrix4fv(shader.uModel, 1, GL_FALSE, &modelMatrix[0][0]);
 
         glBindVertexArray(vao);
-        glDrawArrays(primitive, 0, vertexCount);
+        glDrawArrays(primitive, firstVertex, vertexCount);
         glBindVertexArray(0);
         return;
     }
 
 
     shader.program.bind();
-    if (shader.uModel >= 0) glUniformMatrix4fv(shader.uModel, 1, GL_FALSE, &modelMatrix[0][0]);
-    if (shader.uPrevModel >= 0) glUniformMatrix4fv(shader.uPrevModel, 1, GL_FALSE, &modelMatrix[0][0]);
-    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
-    if (shader.uNormal >= 0) glUniformMatrix3fv(shader.uNormal, 1, GL_FALSE, &normalMatrix[0][0]);
-    if (shader.uColor >= 0) glUniform4fv(shader.uColor, 1, &color[0]);
-    if (shader.uLighting >= 0) glUniform1i(shader.uLighting, lighting ? 1 : 0);
-    if (shader.uUseTexture >= 0) glUniform1i(shader.uUseTexture, diffuseTex ? 1 : 0);
-    if (shader.uDiffuseMap >= 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseTex ? diffuseTex : whiteTexture);
-        glUniform1i(shader.uDiffuseMap, 0);
-    }
-    bool enableNM = useNormalMap && normalTex;
-    if (shader.uUseNormalMap >= 0) glUniform1i(shader.uUseNormalMap, enableNM ? 1 : 0);
-    if (shader.uNormalMap >= 0) {
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, enableNM ? normalTex : whiteTexture);
-        glUniform1i(shader.uNormalMap, 1);
-    }
+    bind_transform(shader, modelMatrix, modelMatrix, color);
+    bind_surface(shader, lighting, diffuseTex, normalTex, useNormalMap);
 
     glBindVertexArray(vao);
 
     bool hiddenLine = currentStyle == RenderStyle::HiddenLineWireframe && is_triangle_primitive(primitive);
-    if (!hiddenLine) {
-        glDrawArrays(primitive, 0, vertexCount);
-        glBindVertexArray(0);
-        return;
-    }
-
-    GLRenderState saved = capture_state();
-
-    glEnable(GL_DEPTH_TEST);
-    glDisable(GL_POLYGON_OFFSET_LINE);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-    glDepthMask(GL_TRUE);
-    glDrawArrays(primitive, 0, vertexCount);
-
-    glEnable(GL_POLYGON_OFFSET_LINE);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-    glDepthMask(GL_FALSE);
-    glPolygonOffset(-1.0f, -1.0f);
-    glLineWidth(2.0f);
-    glDrawArrays(primitive, 0, vertexCount);
+    if (!hiddenLine)
+        glDrawArrays(primitive, firstVertex, vertexCount);
+    else
+        draw_hidden_line([&] { glDrawArrays(primitive, firstVertex, vertexCount); });
 
-    restore_state(saved);
     glBindVertexArray(0);
 }
 
@@ -445,12 +800,33 @@ void Renderer::switch_render_style() {
 
 void Renderer::set_shading_mode(ShadingMode mode) {
     currentShading = mode;
-    auto& s = shaders[static_cast<int>(currentShading)];
+    auto& s = shaders[shader_slot(currentShading)];
     s.program.bind();
     if (s.colorTexture >= 0) glUniform1i(s.colorTexture, 0);
     if (s.velocityTexture >= 0) glUniform1i(s.velocityTexture, 1);
+    if (s.depthTexture >= 0) glUniform1i(s.depthTexture, 2);
+    if (s.neighborMaxTexture >= 0) glUniform1i(s.neighborMaxTexture, 3);
     if (s.uDiffuseMap >= 0) glUniform1i(s.uDiffuseMap, 0);
+    if (s.uDiffuseArray >= 0) glUniform1i(s.uDiffuseArray, 3);
     if (s.uNormalMap >= 0) glUniform1i(s.uNormalMap, 1);
+    if (s.uShadowMap >= 0) glUniform1i(s.uShadowMap, 2);
+}
+
+void Renderer::set_velocity_output(bool enabled) {
+    if (velocityOutput == enabled)
+        return;
+    velocityOutput = enabled;
+    set_shading_mode(currentShading);
+}
+
+void Renderer::set_face_culling(bool enabled) {
+    if (faceCulling == enabled)
+        return;
+    faceCulling = enabled;
+    if (enabled)
+        glEnable(GL_CULL_FACE);
+    else
+        glDisable(GL_CULL_FACE);
 }
 
 void Renderer::switch_shading_mode() {
@@ -470,13 +846,7 @@ const char* Renderer::shading_mode_label() const {
 }
 
 GLuint Renderer::get_or_load_texture(const std::string& path) {
-    if (auto it = textureCache.find(path); it != textureCache.end())
-        return it->second.id;
-
-    Texture2D tex = load_texture_png(path);
-    if (tex.id != 0) {
-        textureCache[path] = tex;
-        return tex.id;
-    }
-    return 0;
+    TextureHandle handle = gAssets.texture_handle(path);
+    gAssets.pin(handle);
+    return gAssets.texture(handle);
 }
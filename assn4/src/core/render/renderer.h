@@ -3,16 +3,21 @@
 #include <glm/glm.hpp>
 #include <array>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "core/render/indirect_draw.h"
+#include "core/render/material.h"
+#include "core/render/motion_blur.h"
 #include "core/render/shader_program.h"
+#include "core/render/shadow_map.h"
 #include "core/render/texture.h"
 
 class Mesh;
 
 enum class RenderStyle { Opaque, Wireframe, HiddenLineWireframe };
 enum class ShadingMode { Gouraud = 0, Phong = 1, PhongNormalMap = 2, DepthOnly = 3, MotionBlur = 4 };
+constexpr int SHADING_MODES = 5;
+constexpr int LIT_SHADING_MODES = 3;   // Gouraud, Phong, PhongNormalMap: the ones writing velocity
 
 struct DirectionalLight {
     glm::vec3 direction = glm::vec3(-0.4f, 0.7f, 0.5f);
@@ -32,7 +37,10 @@ class Renderer {
 private:
     ShaderProgram program; // legacy single program (kept for minimal impact, unused now)
     glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 prevView = glm::mat4(1.0f);   // last frame's view, for camera motion in the velocity buffer
+    bool viewCut = true;                    // next set_view() starts a new history
     glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec2 projectionJitter = glm::vec2(0.0f);   // NDC offset, temporal upsampling
     glm::vec3 viewPos = glm::vec3(0.0f);
     DirectionalLight dirLight;
     std::array<PointLight, MAX_POINT_LIGHTS> pointLights{};
@@ -56,42 +64,161 @@ private:
         GLint uViewPos = -1;
         GLint uUseTexture = -1;
         GLint uDiffuseMap = -1;
+        GLint uDiffuseArray = -1;
+        GLint uDiffuseLayer = -1;
+        GLint uDiffuseRect = -1;
         GLint uUseNormalMap = -1;
         GLint uNormalMap = -1;
         GLint uLightSpaceMatrix = -1;
+        std::array<GLint, MAX_SHADOW_CASCADES> uCascadeLightSpace{};
+        std::array<GLint, MAX_SHADOW_CASCADES> uCascadeSplits{};
+        GLint uCascadeCount = -1;
+        GLint uShadowTaps = -1;
+        GLint uShadowFilterRadius = -1;
+        GLint uShadowBias = -1;
         GLint uShadowMap = -1;
         GLint uUseShadow = -1;
         GLint colorTexture = -1;
         GLint velocityTexture = -1;
+        GLint depthTexture = -1;
+        GLint neighborMaxTexture = -1;
+        GLint uTileSize = -1;
+        GLint uDepthParams = -1;
         GLint uPrevModel = -1;
         GLint uPrevView = -1;   
         GLint uPrevProj = -1;
         GLint useVelocity = -1;
+        GLint uDrawData = -1;
     };
 
-    ShaderHandles shaders[5]; // per-shading-mode shader + uniform handles
+    // per-shading-mode shader + uniform handles, followed by the lit modes built with
+    // NO_VELOCITY for targets without a velocity attachment, then both lit sets built
+    // with INDIRECT (per-draw data from a texture buffer, for multi-draw indirect)
+    ShaderHandles shaders[SHADING_MODES + 3 * LIT_SHADING_MODES];
     GLuint whiteTexture = 0;  // 1x1 fallback texture
-    std::unordered_map<std::string, Texture2D> textureCache; // lazy-loaded texture cache
 
     RenderStyle currentStyle = RenderStyle::Opaque;
     ShadingMode currentShading = ShadingMode::Gouraud;
+    bool velocityOutput = true;
+    bool faceCulling = false;   // mirrors GL_CULL_FACE (off by default in GL)
 
+    // Level of detail: a mesh whose bounding sphere covers less than LOD_FULL_DETAIL_SIZE
+    // of the screen height drops one level per halving of its projected size.
+    static constexpr float LOD_FULL_DETAIL_SIZE = 0.25f;
+    float lodBias = 1.0f;
+    size_t trianglesSubmitted = 0;      // this frame, after LOD selection
+    size_t trianglesFullDetail = 0;     // the same draws at level 0
+    size_t lastTrianglesSubmitted = 0;
+    size_t lastTrianglesFullDetail = 0;
+    size_t drawCalls = 0;               // API draw calls issued by the flushes this frame
+    size_t lastDrawCalls = 0;
+
+    // Material-tagged draws collected during scene traversal, sorted and drawn by flush()
+    struct DrawItem {
+        const Mesh* mesh = nullptr;
+        MaterialId material = INVALID_MATERIAL;
+        uint32_t order = 0;        // submission order keeps the sort deterministic
+        bool transparent = false;
+        glm::mat4 model;
+        glm::mat4 prevModel;
+        glm::vec4 color;
+    };
+    std::vector<DrawItem> drawQueue;
+
+    // Shadow casters: position-only, no material, drawn instanced per mesh by flush().
+    static constexpr int SHADOW_INSTANCES = 32;   // must match depth_instanced.vert
+    struct ShadowItem {
+        const Mesh* mesh = nullptr;
+        glm::mat4 model;
+    };
+    std::vector<ShadowItem> shadowQueue;
+    ShaderProgram depthInstanced;
+    GLint uInstancedLightSpace = -1;
+    GLint uInstancedModels = -1;
+
+    // Multi-draw indirect: each flush turns its sorted queue into one command list and
+    // draws every shader/material run of it with a single call.
+    struct IndirectBatch {
+        const ShaderHandles* shader = nullptr;
+        MaterialId material = INVALID_MATERIAL;
+        const Mesh* mesh = nullptr;   // first draw of the run
+        size_t firstCommand = 0;
+    };
+    IndirectDrawBuffer indirectDraws;
+    std::vector<IndirectBatch> indirectBatches;
+    bool indirectOn = true;
+    ShaderProgram depthIndirect;
+    GLint uIndirectLightSpace = -1;
+
+    int shader_slot(ShadingMode mode, bool indirect = false) const;
+    const Mesh& select_lod(const Mesh& mesh, const glm::mat4& modelMatrix);
+    const ShaderHandles& shader_for(const Mesh& mesh, bool indirect = false) const;
+    bool needs_fallback(const Mesh& mesh) const;
+    void bind_transform(const ShaderHandles& shader, const glm::mat4& modelMatrix,
+                        const glm::mat4& prevModelMatrix, const glm::vec4& color) const;
+    void bind_surface(const ShaderHandles& shader, bool lighting, GLuint diffuseTex,
+                      GLuint normalTex, bool useNormalMap) const;
+    void bind_diffuse(const ShaderHandles& shader, int mode, GLuint texture) const;
+    void bind_normal(const ShaderHandles& shader, GLuint normalTex, bool useNormalMap) const;
+    // rebindTextures = false only updates the per-material layer/rect (same batch as before)
+    void bind_material(const ShaderHandles& shader, const Material& mat, bool normalMap,
+                       bool rebindTextures) const;
+    void draw_geometry(const Mesh& mesh) const;
+    void flush_shadows();
+    bool use_indirect(size_t drawCount) const;
+    void flush_indirect();
+    void flush_shadows_indirect();
+    void upload_projection();
 
 public:
     bool init();
     void shutdown();
 
     void set_view(const glm::mat4& viewMatrix);
+    // Camera cut: the next set_view() uses its own matrix as the previous view, so the
+    // jump does not show up as velocity.
+    void reset_view_history() { viewCut = true; }
     void set_projection(const glm::mat4& projectionMatrix);
+    // Sub-pixel offset (in NDC) applied on top of the projection; zero when not jittering.
+    void set_projection_jitter(const glm::vec2& ndcOffset);
     void set_view_position(const glm::vec3& pos);
-    void set_lights(const DirectionalLight& dir, const std::vector<PointLight>& points);
-    void set_light_space_matrix();
-    void set_shadow_map(GLuint depthMapTexture);
-    void set_motion_blur(bool b);
+    // At most MAX_POINT_LIGHTS of the points are used.
+    void set_lights(const DirectionalLight& dir, const PointLight* points, size_t count);
+    // Depth pass: the light matrix of the cascade being rendered.
+    void set_light_space_matrix(const glm::mat4& lightSpace);
+    // Lighting pass: all cascades, for per-fragment cascade selection.
+    void set_shadow_cascades(const ShadowCascades& cascades);
+    void set_shadow_map(GLuint depthArrayTexture);
+    // PCF taps / radius / bias of the current shadow quality tier.
+    void set_shadow_filter(const ShadowFilter& filter);
+    // Resolve mode for the MotionBlur pass (colour 0, velocity 1, depth 2, neighbour max 3).
+    void set_motion_blur(MotionBlurMode mode);
+    // false: lit modes use the variants without FragVelocity (render target has no velocity attachment)
+    void set_velocity_output(bool enabled);
+    // GL_CULL_FACE, tracked here so per-draw toggles never query GL state.
+    void set_face_culling(bool enabled);
+    bool face_culling() const { return faceCulling; }
 
+    // begin_frame() also closes the previous frame's triangle counters and rolls the view
+    // into prevView.
     void begin_frame();
     void end_frame();
 
+    // Multiplies the projected size used for LOD selection: > 1 keeps detail longer,
+    // 0 always draws full detail.
+    void set_lod_bias(float bias) { lodBias = bias; }
+    float get_lod_bias() const { return lodBias; }
+    // Triangles submitted during the last complete frame (shadow and lighting passes)
+    size_t triangles_submitted() const { return lastTrianglesSubmitted; }
+    size_t triangles_full_detail() const { return lastTrianglesFullDetail; }
+
+    // Multi-draw indirect for the queued draws; without GL 4.3 support (or when off)
+    // flush() issues one call per draw.
+    void set_indirect_draws(bool enabled) { indirectOn = enabled; }
+    bool indirect_draws() const { return indirectOn && indirectDraws.ready(); }
+    // API draw calls issued by flush() during the last complete frame
+    size_t draw_calls() const { return lastDrawCalls; }
+
     void draw_mesh(const Mesh& mesh,
                    const glm::mat4& modelMatrix,
                    const glm::mat4& prevModelMatrix,
@@ -101,6 +228,17 @@ public:
                    GLuint normalTex = 0,
                    bool useNormalMap = false) const;
 
+    // Queue a draw; the color multiplies the material tint.
+    void submit(const Mesh& mesh,
+                const glm::mat4& modelMatrix,
+                const glm::mat4& prevModelMatrix,
+                MaterialId material,
+                const glm::vec4& color = glm::vec4(1.0f));
+    // Depth-pass submission: only the mesh and its world matrix. In DepthOnly mode
+    // submit() takes this path as well.
+    void submit_shadow(const Mesh& mesh, const glm::mat4& modelMatrix);
+    void flush();
+
     void draw_raw(GLuint vao,
                   GLsizei vertexCount,
                   GLenum primitive,
@@ -109,7 +247,8 @@ public:
                   bool lighting = false,
                   GLuint diffuseTex = 0,
                   GLuint normalTex = 0,
-                  bool useNormalMap = false) const;
+                  bool useNormalMap = false,
+                  GLint firstVertex = 0) const;
 
 
     void apply_render_style();
@@ -120,6 +259,7 @@ public:
     ShadingMode get_shading_mode() const { return currentShading; }
     const char* shading_mode_label() const;
 
+    // Loads through gAssets and pins the texture, since callers keep the raw GL id.
     GLuint get_or_load_texture(const std::string& path);
 };
 
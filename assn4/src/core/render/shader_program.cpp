@@ -10,10 +10,15 @@ ShaderProgram::~ShaderProgram() {
     destroy();
 }
 
-GLuint ShaderProgram::compile(GLenum type, const std::string& path) {
+GLuint ShaderProgram::compile(GLenum type, const std::string& path, const std::string& defines) {
     std::string source = load_source(path);
     if (source.empty())
         return 0;
+    if (!defines.empty()) {
+        // #version must stay the first directive
+        size_t afterVersion = source.rfind("#version", 0) == 0 ? source.find('\n') : std::string::npos;
+        source.insert(afterVersion == std::string::npos ? 0 : afterVersion + 1, defines);
+    }
 
     // [C1] create shader object and feed GLSL source
     GLuint shader = glCreateShader(type);
@@ -63,16 +68,17 @@ GLint ShaderProgram::uniform_location(const std::string& name) const {
     return loc;
 }
 
-bool ShaderProgram::load_from_files(const std::string& vertPath, const std::string& fragPath) {
+bool ShaderProgram::load_from_files(const std::string& vertPath, const std::string& fragPath,
+                                    const std::string& defines) {
     // [L0] clean up existing program
     destroy();
 
     // [L1] compile vertex shader
-    GLuint vert = compile(GL_VERTEX_SHADER, vertPath);
+    GLuint vert = compile(GL_VERTEX_SHADER, vertPath, defines);
     if (!vert)
         return false;
     // [L2] compile fragment shader
-    GLuint frag = compile(GL_FRAGMENT_SHADER, fragPath);
+    GLuint frag = compile(GL_FRAGMENT_SHADER, fragPath, defines);
     if (!frag) {
         glDeleteShader(vert);
         return false;
@@ -10,7 +10,7 @@ private:
     GLuint programId = 0;                                           // init 0 (means no program)
     mutable std::unordered_map<std::string, GLint> uniformCache;    // Cache for uniform locations
 
-    GLuint compile(GLenum type, const std::string& path);           // 단일 셰이더를 읽고 컴파일
+    GLuint compile(GLenum type, const std::string& path, const std::string& defines);  // 단일 셰이더를 읽고 컴파일
     std::string load_source(const std::string& path);               // 텍스트 셰이더 파일 로드
     void destroy();                                                 // 기존 프로그램 캐시 해제
 
@@ -28,7 +28,9 @@ public:
     GLint uniform_location(const std::string& name) const; 
     GLuint id() const { return programId; }
 
-    bool load_from_files(const std::string& vertPath, const std::string& fragPath);
+    // defines ("#define NAME\n" lines) are inserted after the #version line of both stages
+    bool load_from_files(const std::string& vertPath, const std::string& fragPath,
+                         const std::string& defines = "");
     void bind() const;    
     void unbind() const;  
 };
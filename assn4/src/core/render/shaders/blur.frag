@@ -4,19 +4,28 @@ out vec4 FragColor;
 
 uniform sampler2D colorTexture; 
 uniform sampler2D velocityTexture; 
-uniform int useVelocity;
+uniform sampler2D depthTexture;
+uniform sampler2D neighborMaxTexture;
+uniform int useVelocity;        // 0 off, 1 simple, 2 tile-max reconstruction
+uniform int uTileSize;          // pixels per velocity tile = max blur radius
+uniform vec2 uDepthParams;      // proj[3][2], proj[2][2]: view depth = x / (ndc_z + y)
 
 const int SAMPLES = 4; 
 
+// reconstruction filter (McGuire et al. 2012)
+const int MIN_SAMPLES = 3;
+const int MAX_SAMPLES = 15;
+const float PIXELS_PER_SAMPLE = 2.0;
+const float SOFT_Z_EXTENT = 1.0;    // view-space depth over which front/back ordering fades
 
-void main()
+
+// Fixed number of taps along the pixel's own velocity
+vec4 simple_blur()
 {
     vec2 velocity = texture(velocityTexture, TexCoords).rg;
 
-    if (useVelocity == 0 || length(velocity) < 0.000001) {
-        FragColor = texture(colorTexture, TexCoords);
-        return;
-    }
+    if (length(velocity) < 0.000001)
+        return texture(colorTexture, TexCoords);
 
     vec2 sampleStep = -velocity / float(SAMPLES);
 
@@ -28,5 +37,85 @@ void main()
         finalColor += texture(colorTexture, clamp(currentCoords, 0.0, 1.0)).rgb;
     }
     
-    FragColor = vec4(finalColor/float(SAMPLES), 1.0);
-}
\ No newline at end of file
+    return vec4(finalColor/float(SAMPLES), 1.0);
+}
+
+// Must match blur_tile_max.frag
+vec2 half_velocity_px(vec2 velocity, vec2 screenSize) {
+    vec2 v = 0.5 * velocity * screenSize;
+    float len = length(v);
+    return len > float(uTileSize) ? v * (float(uTileSize) / len) : v;
+}
+
+float linear_depth(vec2 uv) {
+    float ndc = texture(depthTexture, uv).r * 2.0 - 1.0;
+    return uDepthParams.x / (ndc + uDepthParams.y);
+}
+
+float cone(float dist, float speed) {
+    return clamp(1.0 - dist / speed, 0.0, 1.0);
+}
+
+float cylinder(float dist, float speed) {
+    return 1.0 - smoothstep(0.95 * speed, 1.05 * speed, dist);
+}
+
+// 1 when depth a is not behind depth b, fading out over SOFT_Z_EXTENT
+float not_behind(float za, float zb) {
+    return clamp(1.0 - (za - zb) / SOFT_Z_EXTENT, 0.0, 1.0);
+}
+
+// Gather along the dominant neighbourhood velocity; samples in front of this pixel
+// contribute their own blur, samples behind it show through this pixel's blur.
+vec4 reconstruct()
+{
+    vec4 center = texture(colorTexture, TexCoords);
+    // velocity and tiles are in scene pixels; the colour input and the output may differ in size
+    // (half-resolution post, temporally upsampled colour)
+    vec2 screenSize = vec2(textureSize(velocityTexture, 0));
+    vec2 vn = texelFetch(neighborMaxTexture, ivec2(TexCoords * screenSize) / uTileSize, 0).rg;
+    float speedN = length(vn);
+    if (speedN <= 0.5)
+        return center;  // nothing within a tile moves more than half a pixel
+
+    float speedX = max(length(half_velocity_px(texture(velocityTexture, TexCoords).rg, screenSize)), 0.5);
+    float zx = linear_depth(TexCoords);
+
+    // More samples for longer streaks; odd so the center tap can be skipped
+    int samples = clamp(int(ceil(speedN / PIXELS_PER_SAMPLE)), MIN_SAMPLES, MAX_SAMPLES);
+    samples += 1 - samples % 2;
+    float jitter = fract(sin(dot(gl_FragCoord.xy, vec2(12.9898, 78.233))) * 43758.5453) - 0.5;
+
+    float totalWeight = 1.0 / speedX;
+    vec3 sum = center.rgb * totalWeight;
+    for (int i = 0; i < samples; ++i) {
+        if (i == samples / 2)
+            continue;
+        float t = mix(-1.0, 1.0, (float(i) + jitter + 1.0) / float(samples + 1));
+        vec2 offset = vn * t;
+        vec2 uv = clamp(TexCoords + offset / screenSize, 0.0, 1.0);
+        float dist = length(offset);
+
+        float zy = linear_depth(uv);
+        float speedY = max(length(half_velocity_px(texture(velocityTexture, uv).rg, screenSize)), 0.5);
+        float front = not_behind(zy, zx);
+        float back = not_behind(zx, zy);
+        float w = front * cone(dist, speedY)
+                + back * cone(dist, speedX)
+                + cylinder(dist, speedY) * cylinder(dist, speedX) * 2.0;
+
+        totalWeight += w;
+        sum += texture(colorTexture, uv).rgb * w;
+    }
+    return vec4(sum / totalWeight, 1.0);
+}
+
+void main()
+{
+    if (useVelocity == 1)
+        FragColor = simple_blur();
+    else if (useVelocity == 2)
+        FragColor = reconstruct();
+    else
+        FragColor = texture(colorTexture, TexCoords);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+out vec2 NeighborVelocity;
+
+// Largest tile velocity in the 3x3 neighbourhood, so blur can spill across tile borders
+uniform sampler2D tileMaxTexture;
+
+void main()
+{
+    ivec2 tiles = textureSize(tileMaxTexture, 0);
+    ivec2 tile = ivec2(gl_FragCoord.xy);
+
+    vec2 best = vec2(0.0);
+    float bestLen = 0.0;
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            ivec2 p = clamp(tile + ivec2(x, y), ivec2(0), tiles - 1);
+            vec2 v = texelFetch(tileMaxTexture, p, 0).rg;
+            float len = dot(v, v);
+            if (len > bestLen) {
+                best = v;
+                bestLen = len;
+            }
+        }
+    }
+    NeighborVelocity = best;
+}
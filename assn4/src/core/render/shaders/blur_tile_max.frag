@@ -0,0 +1,34 @@
+#version 330 core
+out vec2 TileVelocity;
+
+// One fragment per tile: the largest velocity among the tile's pixels
+uniform sampler2D velocityTexture;
+uniform int uTileSize;
+
+// Screen-space velocity (uv per frame) -> pixels over half the exposure, at most one tile
+vec2 half_velocity_px(vec2 velocity, vec2 screenSize) {
+    vec2 v = 0.5 * velocity * screenSize;
+    float len = length(v);
+    return len > float(uTileSize) ? v * (float(uTileSize) / len) : v;
+}
+
+void main()
+{
+    ivec2 screenSize = textureSize(velocityTexture, 0);
+    ivec2 origin = ivec2(gl_FragCoord.xy) * uTileSize;
+
+    vec2 best = vec2(0.0);
+    float bestLen = 0.0;
+    for (int y = 0; y < uTileSize; ++y) {
+        for (int x = 0; x < uTileSize; ++x) {
+            ivec2 p = min(origin + ivec2(x, y), screenSize - 1);
+            vec2 v = half_velocity_px(texelFetch(velocityTexture, p, 0).rg, vec2(screenSize));
+            float len = dot(v, v);
+            if (len > bestLen) {
+                best = v;
+                bestLen = len;
+            }
+        }
+    }
+    TileVelocity = best;
+}
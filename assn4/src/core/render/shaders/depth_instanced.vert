@@ -0,0 +1,26 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// Keep in sync with Renderer::SHADOW_INSTANCES
+const int MAX_INSTANCES = 32;
+
+uniform mat4 uLightSpaceMatrix;
+#ifdef INDIRECT
+// Multi-draw indirect: the model matrix is the first 4 of DRAW_DATA_TEXELS (12) per draw
+layout (location = 4) in uint aDrawIndex;
+uniform samplerBuffer uDrawData;
+#else
+uniform mat4 uModels[MAX_INSTANCES];
+#endif
+
+void main()
+{
+#ifdef INDIRECT
+    int base = int(aDrawIndex) * 12;
+    mat4 model = mat4(texelFetch(uDrawData, base), texelFetch(uDrawData, base + 1),
+                      texelFetch(uDrawData, base + 2), texelFetch(uDrawData, base + 3));
+#else
+    mat4 model = uModels[gl_InstanceID];
+#endif
+    gl_Position = uLightSpaceMatrix * model * vec4(aPos, 1.0);
+}
@@ -1,29 +1,57 @@
 #version 330 core
 
 layout (location = 0) out vec4 FragColor;
-layout (location = 1) out vec4 FragVelocity;
 
-// for motion blur
-in vec4 vClipPos; 
+// for motion blur (NO_VELOCITY: variant for frames without a velocity buffer)
+#ifndef NO_VELOCITY
+layout (location = 1) out vec4 FragVelocity;
+in vec4 vClipPos;
 in vec4 vPrevClipPos;
+#endif
 
 in vec3 vLighting;
 in vec2 vTexcoord;
 
+#ifdef INDIRECT
+flat in vec4 vColor;   // per-draw colour from the vertex stage
+#define uColor vColor
+#else
 uniform vec4 uColor;
+#endif
 uniform int uUseTexture;
 uniform sampler2D uDiffuseMap;
+uniform sampler2DArray uDiffuseArray;
+uniform int uDiffuseLayer;
+uniform vec4 uDiffuseRect;
+
+// uUseTexture: 0 none, 1 plain 2D, 2 texture array layer, 3 atlas sub-rect
+vec3 sample_diffuse() {
+    if (uUseTexture == 1)
+        return texture(uDiffuseMap, vTexcoord).rgb;
+    if (uUseTexture == 2)
+        return texture(uDiffuseArray, vec3(vTexcoord, float(uDiffuseLayer))).rgb;
+    if (uUseTexture == 3) {
+        // wrap inside the rect; explicit gradients avoid the mip seam at the fract() jump
+        vec2 uv = uDiffuseRect.xy + fract(vTexcoord) * uDiffuseRect.zw;
+        vec2 dx = dFdx(vTexcoord) * uDiffuseRect.zw;
+        vec2 dy = dFdy(vTexcoord) * uDiffuseRect.zw;
+        return textureGrad(uDiffuseMap, uv, dx, dy).rgb;
+    }
+    return vec3(1.0);
+}
 
 void main() {
-    vec3 texSample = (uUseTexture == 1) ? texture(uDiffuseMap, vTexcoord).rgb : vec3(1.0);
+    vec3 texSample = sample_diffuse();
     vec3 baseColor = texSample * uColor.rgb;
     vec3 finalColor = vLighting * baseColor;
     FragColor = vec4(finalColor, uColor.a);
 
+#ifndef NO_VELOCITY
     vec2 ndcPos = vClipPos.xy / vClipPos.w;
     vec2 ndcPrevPos = vPrevClipPos.xy / vPrevClipPos.w;
     vec2 screenPos = ndcPos * 0.5 + 0.5;
     vec2 screenPrevPos = ndcPrevPos * 0.5 + 0.5;
     FragVelocity = vec4(screenPos - screenPrevPos, 0.0, 1);
+#endif
 
 }
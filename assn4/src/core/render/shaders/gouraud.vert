@@ -14,20 +14,35 @@ const float attC2 = 0.08;      // attenuation linear term
 const float attC3 = 0.032;     // attenuation quadratic term
 const int   MAX_POINT_LIGHTS = 4;
 
+#ifdef INDIRECT
+// Multi-draw indirect: this draw's data sits in uDrawData at the per-instance index
+layout (location = 4) in uint aDrawIndex;
+uniform samplerBuffer uDrawData;
+flat out vec4 vColor;
+mat4 uModel;
+mat3 uNormalMatrix;
+#else
 uniform mat4 uModel;
+uniform mat3 uNormalMatrix;
+#endif
 uniform mat4 uView;
 uniform mat4 uProj;
-uniform mat3 uNormalMatrix;
 uniform vec4 uColor;
 uniform int uUseLighting;
 uniform vec3 uViewPos;
 
-// for motion blur
+// for motion blur (NO_VELOCITY: variant for frames without a velocity buffer)
+#ifndef NO_VELOCITY
+#ifdef INDIRECT
+mat4 uPrevModel;
+#else
 uniform mat4 uPrevModel;
+#endif
 uniform mat4 uPrevView;
 uniform mat4 uPrevProj;
 out vec4 vClipPos;
 out vec4 vPrevClipPos;
+#endif
 
 struct DirLight { vec3 direction; vec3 color; float intensity; };
 struct PointLight { vec3 position; vec3 color; float intensity; };
@@ -62,7 +77,25 @@ vec3 apply_light(vec3 N, vec3 worldPos) {
     return colorAccum;
 }
 
+#ifdef INDIRECT
+void load_draw_data() {
+    int base = int(aDrawIndex) * 12;   // DRAW_DATA_TEXELS
+    uModel = mat4(texelFetch(uDrawData, base), texelFetch(uDrawData, base + 1),
+                  texelFetch(uDrawData, base + 2), texelFetch(uDrawData, base + 3));
+#ifndef NO_VELOCITY
+    uPrevModel = mat4(texelFetch(uDrawData, base + 4), texelFetch(uDrawData, base + 5),
+                      texelFetch(uDrawData, base + 6), texelFetch(uDrawData, base + 7));
+#endif
+    uNormalMatrix = mat3(texelFetch(uDrawData, base + 8).xyz, texelFetch(uDrawData, base + 9).xyz,
+                         texelFetch(uDrawData, base + 10).xyz);
+    vColor = texelFetch(uDrawData, base + 11);
+}
+#endif
+
 void main() {
+#ifdef INDIRECT
+    load_draw_data();
+#endif
     vec4 worldPos = uModel * vec4(aPosition, 1.0);
     gl_Position = uProj * uView * worldPos;
 
@@ -70,7 +103,9 @@ void main() {
     vLighting = (uUseLighting == 0) ? vec3(1.0) : apply_light(N, worldPos.xyz);
     vTexcoord = aTexcoord;
 
+#ifndef NO_VELOCITY
     vClipPos = gl_Position;
     vec4 prevWorldPos = uPrevModel * vec4(aPosition, 1.0);
     vPrevClipPos = uPrevProj * uPrevView * prevWorldPos;
+#endif
 }
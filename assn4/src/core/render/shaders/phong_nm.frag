@@ -1,30 +1,58 @@
 #version 330 core
 
 layout (location = 0) out vec4 FragColor;
-layout (location = 1) out vec4 FragVelocity;
 
-// for motion blur
-in vec4 vClipPos; 
+// for motion blur (NO_VELOCITY: variant for frames without a velocity buffer)
+#ifndef NO_VELOCITY
+layout (location = 1) out vec4 FragVelocity;
+in vec4 vClipPos;
 in vec4 vPrevClipPos;
+#endif
 
 in vec3 vWorldPos;
 in vec3 vNormal;
 in vec3 vTangent;
 in vec2 vTexcoord;
-in vec4 vFragPosLightSpace;
+in float vViewDepth;
 
+#ifdef INDIRECT
+flat in vec4 vColor;   // per-draw colour from the vertex stage
+#define uColor vColor
+#else
 uniform vec4 uColor;
+#endif
 uniform int uUseLighting;
 uniform int uUseTexture;
 uniform sampler2D uDiffuseMap;
+uniform sampler2DArray uDiffuseArray;
+uniform int uDiffuseLayer;
+uniform vec4 uDiffuseRect;
 uniform int uUseNormalMap;
 uniform sampler2D uNormalMap;
 uniform vec3 uViewPos;
 
-// shadowmap texture
-uniform sampler2D uShadowMap;
+// shadowmap texture: one layer per cascade, sampled with hardware depth compare
+const int MAX_SHADOW_CASCADES = 4;
+const int MAX_SHADOW_TAPS = 16;
+uniform sampler2DArrayShadow uShadowMap;
 uniform int uUseShadow;
-const float bias = 0.005;
+uniform int uCascadeCount;
+uniform mat4 uCascadeLightSpace[MAX_SHADOW_CASCADES];
+uniform float uCascadeSplits[MAX_SHADOW_CASCADES];
+uniform int uShadowTaps;            // 1 = single compare, otherwise Poisson-disk PCF
+uniform float uShadowFilterRadius;  // PCF kernel radius in texels
+uniform vec2 uShadowBias;           // x: constant, y: scaled by the slope to the light
+
+const vec2 poissonDisk[MAX_SHADOW_TAPS] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2( 0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870), vec2( 0.34495938,  0.29387760),
+    vec2(-0.91588581,  0.45771432), vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543,  0.27676845), vec2( 0.97484398,  0.75648379),
+    vec2( 0.44323325, -0.97511554), vec2( 0.53742981, -0.47373420),
+    vec2(-0.26496911, -0.41893023), vec2( 0.79197514,  0.19090188),
+    vec2(-0.24188840,  0.99706507), vec2(-0.81409955,  0.91437590),
+    vec2( 0.19984126,  0.78641367), vec2( 0.14383161, -0.14100790)
+);
 
 // Lighting constants (matches lecture notation)
 const float kA = 0.2;          // ambient coefficient
@@ -42,11 +70,18 @@ uniform DirLight uDirLight;
 uniform PointLight uPointLights[MAX_POINT_LIGHTS];
 uniform int uPointLightCount;
 
-float calculate_shadow()
+float calculate_shadow(vec3 N, vec3 L)
 {
-    if (vFragPosLightSpace.w <= 0.0) return 1.0; 
+    int cascade = uCascadeCount - 1;
+    for (int i = 0; i < uCascadeCount - 1; ++i) {
+        if (vViewDepth < uCascadeSplits[i]) {
+            cascade = i;
+            break;
+        }
+    }
 
-    vec3 projCoords = vFragPosLightSpace.xyz / vFragPosLightSpace.w;
+    vec4 fragPosLightSpace = uCascadeLightSpace[cascade] * vec4(vWorldPos, 1.0);
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
 
     projCoords = projCoords * 0.5 + 0.5;
 
@@ -55,18 +90,34 @@ float calculate_shadow()
         projCoords.z > 1.0 || projCoords.z < 0.0) 
         return 1.0;
     
-    if (projCoords.z > texture(uShadowMap, projCoords.xy).r + bias)
-        return 0.0;
-    
-    return 1.0;
+    // Slope-scaled bias: surfaces at a grazing angle to the light need more offset
+    float cosTheta = clamp(dot(N, L), 0.05, 1.0);
+    float slope = sqrt(1.0 - cosTheta * cosTheta) / cosTheta;
+    float reference = projCoords.z - min(uShadowBias.x + uShadowBias.y * slope, 0.02);
+    float layer = float(cascade);
+
+    if (uShadowTaps <= 1)
+        return texture(uShadowMap, vec4(projCoords.xy, layer, reference));
+
+    // Poisson-disk PCF, rotated per pixel so undersampling shows as fine noise, not bands
+    vec2 radius = uShadowFilterRadius / vec2(textureSize(uShadowMap, 0).xy);
+    float angle = 6.2831853 * fract(sin(dot(gl_FragCoord.xy, vec2(12.9898, 78.233))) * 43758.5453);
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    int taps = min(uShadowTaps, MAX_SHADOW_TAPS);
+    float lit = 0.0;
+    for (int i = 0; i < taps; ++i) {
+        vec2 offset = rotation * poissonDisk[i] * radius;
+        lit += texture(uShadowMap, vec4(projCoords.xy + offset, layer, reference));
+    }
+    return lit / float(taps);
 }
 
 vec3 apply_light(vec3 baseColor, vec3 N, vec3 viewDir) {
-    float shadowFactor = uUseShadow == 1 ? calculate_shadow() : 1.0;
+    vec3 Ld = normalize(-uDirLight.direction);
+    float shadowFactor = uUseShadow == 1 ? calculate_shadow(N, Ld) : 1.0;
 
     vec3 colorAccum = kA * baseColor; // ambient
 
-    vec3 Ld = normalize(-uDirLight.direction);
     float diffD = max(dot(N, Ld), 0.0);
     vec3 halfwayD = normalize(Ld + viewDir);
     float specD = pow(max(dot(N, halfwayD), 0.0), shininess);
@@ -95,12 +146,31 @@ vec3 sample_normal() {
     vec3 B = normalize(cross(N, T));
 
     mat3 TBN = mat3(T, B, N);
-    vec3 mapN = texture(uNormalMap, vTexcoord).xyz * 2.0 - 1.0;
+    // Only XY is trusted: BC5-cooked maps store two channels, so Z is rebuilt.
+    vec3 mapN;
+    mapN.xy = texture(uNormalMap, vTexcoord).xy * 2.0 - 1.0;
+    mapN.z = sqrt(max(1.0 - dot(mapN.xy, mapN.xy), 0.0));
     return normalize(TBN * mapN);
 }
 
+// uUseTexture: 0 none, 1 plain 2D, 2 texture array layer, 3 atlas sub-rect
+vec3 sample_diffuse() {
+    if (uUseTexture == 1)
+        return texture(uDiffuseMap, vTexcoord).rgb;
+    if (uUseTexture == 2)
+        return texture(uDiffuseArray, vec3(vTexcoord, float(uDiffuseLayer))).rgb;
+    if (uUseTexture == 3) {
+        // wrap inside the rect; explicit gradients avoid the mip seam at the fract() jump
+        vec2 uv = uDiffuseRect.xy + fract(vTexcoord) * uDiffuseRect.zw;
+        vec2 dx = dFdx(vTexcoord) * uDiffuseRect.zw;
+        vec2 dy = dFdy(vTexcoord) * uDiffuseRect.zw;
+        return textureGrad(uDiffuseMap, uv, dx, dy).rgb;
+    }
+    return vec3(1.0);
+}
+
 void main() {
-    vec3 texSample = (uUseTexture == 1) ? texture(uDiffuseMap, vTexcoord).rgb : vec3(1.0);
+    vec3 texSample = sample_diffuse();
     vec3 baseColor = texSample * uColor.rgb;
 
     if (uUseLighting == 0) {
@@ -113,9 +183,11 @@ void main() {
     vec3 lit = apply_light(baseColor, N, viewDir);
     FragColor = vec4(lit, uColor.a);
 
+#ifndef NO_VELOCITY
     vec2 ndcPos = vClipPos.xy / vClipPos.w;
     vec2 ndcPrevPos = vPrevClipPos.xy / vPrevClipPos.w;
     vec2 screenPos = ndcPos * 0.5 + 0.5;
     vec2 screenPrevPos = ndcPrevPos * 0.5 + 0.5;
     FragVelocity = vec4(screenPos - screenPrevPos, 0.0, 1);
+#endif
 }
@@ -5,36 +5,70 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexcoord;
 layout (location = 3) in vec3 aTangent;
 
+#ifdef INDIRECT
+// Multi-draw indirect: this draw's data sits in uDrawData at the per-instance index
+layout (location = 4) in uint aDrawIndex;
+uniform samplerBuffer uDrawData;
+flat out vec4 vColor;
+mat4 uModel;
+mat3 uNormalMatrix;
+#else
 uniform mat4 uModel;
+uniform mat3 uNormalMatrix;
+#endif
 uniform mat4 uView;
 uniform mat4 uProj;
-uniform mat3 uNormalMatrix;
-uniform mat4 uLightSpaceMatrix;
 
 out vec3 vWorldPos;
 out vec3 vNormal;
 out vec3 vTangent;
 out vec2 vTexcoord;
-out vec4 vFragPosLightSpace;
+out float vViewDepth;   // for shadow cascade selection
 
-// for motion blur
+// for motion blur (NO_VELOCITY: variant for frames without a velocity buffer)
+#ifndef NO_VELOCITY
+#ifdef INDIRECT
+mat4 uPrevModel;
+#else
 uniform mat4 uPrevModel;
+#endif
 uniform mat4 uPrevView;
 uniform mat4 uPrevProj;
 out vec4 vClipPos;
 out vec4 vPrevClipPos;
+#endif
+
+#ifdef INDIRECT
+void load_draw_data() {
+    int base = int(aDrawIndex) * 12;   // DRAW_DATA_TEXELS
+    uModel = mat4(texelFetch(uDrawData, base), texelFetch(uDrawData, base + 1),
+                  texelFetch(uDrawData, base + 2), texelFetch(uDrawData, base + 3));
+#ifndef NO_VELOCITY
+    uPrevModel = mat4(texelFetch(uDrawData, base + 4), texelFetch(uDrawData, base + 5),
+                      texelFetch(uDrawData, base + 6), texelFetch(uDrawData, base + 7));
+#endif
+    uNormalMatrix = mat3(texelFetch(uDrawData, base + 8).xyz, texelFetch(uDrawData, base + 9).xyz,
+                         texelFetch(uDrawData, base + 10).xyz);
+    vColor = texelFetch(uDrawData, base + 11);
+}
+#endif
 
 void main() {
+#ifdef INDIRECT
+    load_draw_data();
+#endif
     vec4 worldPos = uModel * vec4(aPosition, 1.0);
-    gl_Position = uProj * uView * worldPos;
+    vec4 viewPos = uView * worldPos;
+    gl_Position = uProj * viewPos;
+    vViewDepth = -viewPos.z;
     vWorldPos = worldPos.xyz;
     vNormal = normalize(uNormalMatrix * aNormal);
     vTangent = normalize(uNormalMatrix * aTangent);
     vTexcoord = aTexcoord;
 
-    vFragPosLightSpace = uLightSpaceMatrix * worldPos;
-
+#ifndef NO_VELOCITY
     vClipPos = gl_Position;
     vec4 prevWorldPos = uPrevModel * vec4(aPosition, 1.0);
     vPrevClipPos = uPrevProj * uPrevView * prevWorldPos;
+#endif
 }
@@ -0,0 +1,12 @@
+#version 330 core
+in vec2 TexCoords;
+
+uniform sampler2D staticDepth;      // static casters over the whole shadow bounds
+uniform mat4 uCascadeToStatic;      // cascade light NDC -> static layer light NDC
+
+void main()
+{
+    // Same light view and depth range, so the stored depth is valid in the cascade as is.
+    vec2 ndc = (uCascadeToStatic * vec4(TexCoords * 2.0 - 1.0, 0.0, 1.0)).xy;
+    gl_FragDepth = texture(staticDepth, ndc * 0.5 + 0.5).r;
+}
@@ -0,0 +1,10 @@
+#version 330 core
+
+in float vBrightness;
+
+layout (location = 0) out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(vec3(vBrightness), 1.0);
+}
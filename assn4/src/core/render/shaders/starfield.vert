@@ -0,0 +1,31 @@
+#version 330 core
+
+uniform mat4 uViewProj;
+uniform uint uSeed;
+uniform float uExtent;      // half size of the cube the stars fill
+
+out float vBrightness;
+
+// lowbias32 (Wellons): good avalanche for sequential ids
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float unit_float(uint h)
+{
+    return float(h >> 8) * (1.0 / 16777216.0);   // 24 bits → [0, 1)
+}
+
+void main()
+{
+    uint base = hash(uint(gl_VertexID) ^ hash(uSeed));
+    vec3 p = vec3(unit_float(hash(base)), unit_float(hash(base + 1u)), unit_float(hash(base + 2u)));
+    vBrightness = 0.6 + 0.4 * unit_float(hash(base + 3u));
+    gl_Position = uViewProj * vec4((p * 2.0 - 1.0) * uExtent, 1.0);
+}
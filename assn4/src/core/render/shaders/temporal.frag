@@ -0,0 +1,66 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D colorTexture;     // this frame: internal resolution, jittered
+uniform sampler2D velocityTexture;  // uv motion since the previous frame, internal resolution
+uniform sampler2D historyTexture;   // previous output, output resolution
+uniform vec2 uJitterPx;             // this frame's jitter in internal pixels
+uniform int uHistoryValid;
+
+const float MIN_ALPHA = 0.05;   // weight of a new sample far from the output pixel
+const float MAX_ALPHA = 0.25;   // weight of a new sample right on the output pixel
+
+vec3 rgb_to_ycocg(vec3 c)
+{
+    return vec3( 0.25 * c.r + 0.5 * c.g + 0.25 * c.b,
+                 0.5  * c.r             - 0.5  * c.b,
+                -0.25 * c.r + 0.5 * c.g - 0.25 * c.b);
+}
+
+vec3 ycocg_to_rgb(vec3 c)
+{
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+void main()
+{
+    // The jitter moved the image by uJitterPx, so this output pixel's content sits there.
+    vec2 inSize = vec2(textureSize(colorTexture, 0));
+    vec2 uv = TexCoords + uJitterPx / inSize;
+    vec2 pos = uv * inSize;
+    ivec2 center = ivec2(floor(pos));
+    ivec2 maxTexel = ivec2(inSize) - 1;
+
+    if (uHistoryValid == 0) {
+        FragColor = vec4(texture(colorTexture, uv).rgb, 1.0);
+        return;
+    }
+
+    vec2 prevUv = TexCoords - texture(velocityTexture, uv).rg;
+    if (any(lessThan(prevUv, vec2(0.0))) || any(greaterThan(prevUv, vec2(1.0)))) {
+        FragColor = vec4(texture(colorTexture, uv).rgb, 1.0);   // disoccluded at the screen edge
+        return;
+    }
+
+    // Neighbourhood bounds of the new samples reject stale history (ghosting).
+    vec3 current = vec3(0.0);
+    vec3 lo = vec3(1e9);
+    vec3 hi = vec3(-1e9);
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            ivec2 texel = clamp(center + ivec2(x, y), ivec2(0), maxTexel);
+            vec3 c = rgb_to_ycocg(texelFetch(colorTexture, texel, 0).rgb);
+            lo = min(lo, c);
+            hi = max(hi, c);
+            if (x == 0 && y == 0)
+                current = c;
+        }
+    }
+    vec3 history = clamp(rgb_to_ycocg(texture(historyTexture, prevUv).rgb), lo, hi);
+
+    // Trust the new sample more the closer its (jittered) centre is to this pixel.
+    vec2 d = fract(pos) - 0.5;
+    float alpha = mix(MIN_ALPHA, MAX_ALPHA, exp(-8.0 * dot(d, d)));
+    FragColor = vec4(ycocg_to_rgb(mix(history, current, alpha)), 1.0);
+}
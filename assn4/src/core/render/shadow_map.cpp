@@ -0,0 +1,310 @@
+#include "core/render/shadow_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace {
+constexpr float SPLIT_LAMBDA = 0.5f;    // blend of logarithmic (1) and uniform (0) splits
+constexpr int RESOLUTION_ALIGN = 64;
+
+// Keep the total texel count of the array at or below one base-size layer.
+int layer_size(int baseSize, int cascadeCount) {
+    int size = static_cast<int>(baseSize / std::sqrt(static_cast<float>(cascadeCount)));
+    return std::max(RESOLUTION_ALIGN, size / RESOLUTION_ALIGN * RESOLUTION_ALIGN);
+}
+
+float view_depth(const glm::mat4& view, const glm::vec3& p) {
+    return -(view * glm::vec4(p, 1.0f)).z;
+}
+}
+
+ShadowFilter shadow_filter(ShadowQuality quality) {
+    switch (quality) {
+    case ShadowQuality::Hard:      return {1, 0.0f, false, 0.005f, 0.0f};
+    case ShadowQuality::Hardware:  return {1, 0.0f, true, 0.002f, 0.004f};
+    case ShadowQuality::Poisson8:  return {8, 1.5f, true, 0.002f, 0.006f};
+    case ShadowQuality::Poisson16: return {MAX_SHADOW_TAPS, 2.5f, true, 0.002f, 0.008f};
+    }
+    return {};
+}
+
+const char* shadow_quality_name(ShadowQuality quality) {
+    switch (quality) {
+    case ShadowQuality::Hard:      return "Hard";
+    case ShadowQuality::Hardware:  return "Hardware PCF";
+    case ShadowQuality::Poisson8:  return "Poisson PCF x8";
+    case ShadowQuality::Poisson16: return "Poisson PCF x16";
+    }
+    return "Unknown";
+}
+
+bool ShadowMap::init(int baseSize, int cascadeCount) {
+    baseResolution = baseSize;
+    cascades.count = std::clamp(cascadeCount, 1, MAX_SHADOW_CASCADES);
+    glGenFramebuffers(1, &fbo);
+    allocate();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete)
+        std::cerr << "ERROR::FRAMEBUFFER:: Shadow framebuffer is not complete!" << std::endl;
+    return complete;
+}
+
+void ShadowMap::allocate() {
+    if (depthArray)
+        glDeleteTextures(1, &depthArray);
+
+    resolution = layer_size(baseResolution, cascades.count);
+    glGenTextures(1, &depthArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, cascades.count,
+                 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // Sampled through sampler2DArrayShadow: the texture unit does the depth compare
+    GLint filter = shadow_filter(quality).linear ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    // Outside the light frustum reads as fully lit
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void ShadowMap::release() {
+    set_static_cache(false);
+    if (depthArray) glDeleteTextures(1, &depthArray);
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    depthArray = fbo = 0;
+}
+
+bool ShadowMap::set_static_cache(bool enabled) {
+    staticValid = false;
+    if (enabled == static_cache())
+        return true;
+    if (!enabled) {
+        glDeleteTextures(1, &staticDepth);
+        glDeleteFramebuffers(1, &staticFbo);
+        staticDepth = staticFbo = 0;
+        return true;
+    }
+
+    if (!resampleProgram.id()) {
+        if (!resampleProgram.load_from_files("core/render/shaders/blur.vert",
+                                             "core/render/shaders/shadow_resample.frag"))
+            return false;
+        resampleProgram.bind();
+        glUniform1i(resampleProgram.uniform_location("staticDepth"), 0);
+        resampleProgram.unbind();
+    }
+
+    glGenTextures(1, &staticDepth);
+    glBindTexture(GL_TEXTURE_2D, staticDepth);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, baseResolution, baseResolution, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // Read back as raw depth by the resample pass; outside the bounds nothing is cached
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &staticFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, staticFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, staticDepth, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "ERROR::FRAMEBUFFER:: Static shadow framebuffer is not complete!" << std::endl;
+        set_static_cache(false);
+    }
+    return complete;
+}
+
+void ShadowMap::set_cascade_count(int count) {
+    count = std::clamp(count, 1, MAX_SHADOW_CASCADES);
+    if (count == cascades.count)
+        return;
+    cascades.count = count;
+    if (fbo)
+        allocate();
+}
+
+void ShadowMap::set_quality(ShadowQuality q) {
+    quality = q;
+    if (!depthArray)
+        return;
+    GLint filter = shadow_filter(quality).linear ? GL_LINEAR : GL_NEAREST;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void ShadowMap::set_bounds(const glm::vec3& minCorner, const glm::vec3& maxCorner) {
+    boundsMin = minCorner;
+    boundsMax = maxCorner;
+}
+
+void ShadowMap::update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& lightDir) {
+    // Camera frustum corners: [0..3] near plane, [4..7] far plane.
+    glm::mat4 invViewProj = glm::inverse(projection * view);
+    std::array<glm::vec3, 8> frustum;
+    for (int i = 0; i < 8; ++i) {
+        glm::vec4 ndc((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+        glm::vec4 world = invViewProj * ndc;
+        frustum[i] = glm::vec3(world) / world.w;
+    }
+    float nearDepth = view_depth(view, frustum[0]);
+    float farDepth = view_depth(view, frustum[4]);
+
+    std::array<glm::vec3, 8> bounds;
+    for (int i = 0; i < 8; ++i)
+        bounds[i] = glm::vec3((i & 1) ? boundsMax.x : boundsMin.x,
+                              (i & 2) ? boundsMax.y : boundsMin.y,
+                              (i & 4) ? boundsMax.z : boundsMin.z);
+
+    // Only the depth range where the frustum overlaps the bounds is worth splitting.
+    float minDepth = farDepth, maxDepth = nearDepth;
+    for (const auto& p : bounds) {
+        float d = view_depth(view, p);
+        minDepth = std::min(minDepth, d);
+        maxDepth = std::max(maxDepth, d);
+    }
+    float sliceNear = std::clamp(minDepth, nearDepth, farDepth);
+    float sliceFar = std::clamp(maxDepth, sliceNear + 1e-3f, farDepth);
+
+    glm::vec3 dir = glm::normalize(lightDir);
+    glm::vec3 up = std::abs(dir.z) > 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    glm::mat4 lightView = glm::lookAt(center - dir, center, up);
+
+    // Every caster inside the bounds must land inside each cascade's depth range.
+    float casterMinZ = 1e30f, casterMaxZ = -1e30f;
+    for (const auto& p : bounds) {
+        float z = (lightView * glm::vec4(p, 1.0f)).z;
+        casterMinZ = std::min(casterMinZ, z);
+        casterMaxZ = std::max(casterMaxZ, z);
+    }
+    float nearZ = -casterMaxZ - 1.0f, farZ = -casterMinZ + 1.0f;
+
+    // The static layer covers the whole bounds, so it only changes with the light.
+    glm::vec2 boundsLsMin(1e30f), boundsLsMax(-1e30f);
+    for (const auto& p : bounds) {
+        glm::vec2 ls(lightView * glm::vec4(p, 1.0f));
+        boundsLsMin = glm::min(boundsLsMin, ls);
+        boundsLsMax = glm::max(boundsLsMax, ls);
+    }
+    staticFit = glm::ortho(boundsLsMin.x, boundsLsMax.x, boundsLsMin.y, boundsLsMax.y, nearZ, farZ) * lightView;
+
+    float prevSplit = sliceNear;
+    for (int c = 0; c < cascades.count; ++c) {
+        float t = static_cast<float>(c + 1) / static_cast<float>(cascades.count);
+        float logSplit = sliceNear * std::pow(sliceFar / std::max(sliceNear, 1e-3f), t);
+        float uniSplit = sliceNear + (sliceFar - sliceNear) * t;
+        float split = SPLIT_LAMBDA * logSplit + (1.0f - SPLIT_LAMBDA) * uniSplit;
+
+        // Slice corners by interpolating along the frustum edges, then clip to the bounds.
+        glm::vec3 sliceMin(1e30f), sliceMax(-1e30f);
+        for (int i = 0; i < 4; ++i) {
+            for (float d : {prevSplit, split}) {
+                float s = (d - nearDepth) / (farDepth - nearDepth);
+                glm::vec3 p = glm::mix(frustum[i], frustum[i + 4], s);
+                sliceMin = glm::min(sliceMin, p);
+                sliceMax = glm::max(sliceMax, p);
+            }
+        }
+        sliceMin = glm::clamp(sliceMin, boundsMin, boundsMax);
+        sliceMax = glm::clamp(sliceMax, boundsMin, boundsMax);
+
+        glm::vec2 lsMin(1e30f), lsMax(-1e30f);
+        for (int i = 0; i < 8; ++i) {
+            glm::vec3 p((i & 1) ? sliceMax.x : sliceMin.x,
+                        (i & 2) ? sliceMax.y : sliceMin.y,
+                        (i & 4) ? sliceMax.z : sliceMin.z);
+            glm::vec2 ls(lightView * glm::vec4(p, 1.0f));
+            lsMin = glm::min(lsMin, ls);
+            lsMax = glm::max(lsMax, ls);
+        }
+
+        // Snap to whole texels so the map does not shimmer as the camera moves.
+        float extent = std::max(lsMax.x - lsMin.x, lsMax.y - lsMin.y);
+        float texel = std::max(extent, 1e-3f) / static_cast<float>(resolution);
+        lsMin = glm::floor(lsMin / texel) * texel;
+        lsMax = lsMin + glm::vec2(std::ceil(extent / texel) * texel + texel);
+
+        glm::mat4 lightProj = glm::ortho(lsMin.x, lsMax.x, lsMin.y, lsMax.y, nearZ, farZ);
+        cascades.lightSpace[c] = lightProj * lightView;
+        cascades.splitDepth[c] = split;
+        prevSplit = split;
+    }
+}
+
+void ShadowMap::begin_cascade(int index, bool clear) const {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, index);
+    glViewport(0, 0, resolution, resolution);
+    if (clear)
+        glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void ShadowMap::begin_static_layer() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, staticFbo);
+    glViewport(0, 0, baseResolution, baseResolution);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void ShadowMap::end_static_update() {
+    staticLightSpace = staticFit;
+    staticValid = true;
+}
+
+void ShadowMap::resample_static_layer(int index, const std::function<void()>& drawQuad) const {
+    GLint program = 0, depthFunc = GL_LESS;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean cull = glIsEnabled(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);   // depth writes need the test on; ALWAYS overwrites every texel
+    glDepthFunc(GL_ALWAYS);
+    glDisable(GL_CULL_FACE);
+
+    // Both fits share the light view and depth range; only the x/y scale and offset differ.
+    glm::mat4 cascadeToStatic = staticFit * glm::inverse(cascades.lightSpace[index]);
+    resampleProgram.bind();
+    glUniformMatrix4fv(resampleProgram.uniform_location("uCascadeToStatic"), 1, GL_FALSE,
+                       glm::value_ptr(cascadeToStatic));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, staticDepth);
+    drawQuad();
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glUseProgram(program);
+    glDepthFunc(depthFunc);
+    if (!depthTest)
+        glDisable(GL_DEPTH_TEST);
+    if (cull)
+        glEnable(GL_CULL_FACE);
+}
+
+size_t ShadowMap::byte_size() const {
+    size_t bytes = static_cast<size_t>(resolution) * resolution * cascades.count * 4;
+    if (staticDepth)
+        bytes += static_cast<size_t>(baseResolution) * baseResolution * 4;
+    return bytes;
+}
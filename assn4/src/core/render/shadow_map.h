@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+
+#include <functional>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "core/render/shader_program.h"
+
+constexpr int MAX_SHADOW_CASCADES = 4;
+constexpr int MAX_SHADOW_TAPS = 16;   // must match the Poisson disk in phong*.frag
+
+// Receiver-side filtering tiers, cheapest first.
+//   Hard:      one nearest-texel compare, constant bias (the original look)
+//   Hardware:  one compare with GL_LINEAR, i.e. 2x2 hardware PCF
+//   Poisson8/16: that many hardware-PCF taps on a rotated Poisson disk
+enum class ShadowQuality { Hard, Hardware, Poisson8, Poisson16 };
+constexpr int SHADOW_QUALITY_COUNT = 4;
+
+struct ShadowFilter {
+    int taps = 1;
+    float radius = 0.0f;         // Poisson kernel radius in texels
+    bool linear = false;         // hardware 2x2 PCF per compare
+    float constantBias = 0.005f; // in light NDC depth [0, 1]
+    float slopeBias = 0.0f;      // scaled by tan(angle between normal and light)
+};
+
+ShadowFilter shadow_filter(ShadowQuality quality);
+const char* shadow_quality_name(ShadowQuality quality);
+
+// Per-frame cascade data consumed by the lit shaders.
+struct ShadowCascades {
+    std::array<glm::mat4, MAX_SHADOW_CASCADES> lightSpace{};
+    std::array<float, MAX_SHADOW_CASCADES> splitDepth{};   // far view-space depth of each cascade
+    int count = 1;
+};
+
+// Directional-light shadow map stored as a depth texture array, one layer per cascade.
+// Every frame the light frustum of each cascade is fitted to the matching slice of the
+// camera frustum clipped to the shadow bounds, instead of a fixed box over the world.
+//
+// Casters that never move can go into an optional static layer: one base-size depth map
+// fitted to the whole bounds rather than to the camera, so it is re-rendered only when the
+// light or the static set changes. Each frame it is resampled into every cascade (same
+// light view and depth range, so depths carry over unchanged) and just the dynamic casters
+// are drawn on top. It is allocated only while the cache is enabled.
+class ShadowMap {
+private:
+    GLuint fbo = 0;
+    GLuint depthArray = 0;
+    GLuint staticFbo = 0;
+    GLuint staticDepth = 0;
+    ShaderProgram resampleProgram;
+    bool staticValid = false;
+    ShadowQuality quality = ShadowQuality::Hard;
+    glm::mat4 staticFit = glm::mat4(1.0f);          // camera-independent fit over the bounds
+    glm::mat4 staticLightSpace = glm::mat4(1.0f);   // fit the cache was rendered with
+    int resolution = 0;            // per layer
+    int baseResolution = 1024;     // single-cascade size; more cascades share the same texel budget
+    glm::vec3 boundsMin = glm::vec3(-1.0f);
+    glm::vec3 boundsMax = glm::vec3(1.0f);
+    ShadowCascades cascades;
+
+    void allocate();
+
+public:
+    ShadowMap() = default;
+
+    ShadowMap(const ShadowMap&) = delete;
+    ShadowMap& operator=(const ShadowMap&) = delete;
+
+    bool init(int baseSize, int cascadeCount = 1);
+    void release();
+
+    // Clamped to [1, MAX_SHADOW_CASCADES]; reallocates the array.
+    void set_cascade_count(int count);
+    int cascade_count() const { return cascades.count; }
+
+    // Texture filtering for the tier; the matching shader uniforms are set by the renderer.
+    void set_quality(ShadowQuality q);
+    ShadowQuality get_quality() const { return quality; }
+
+    // World-space box holding every caster and receiver that can show a shadow.
+    void set_bounds(const glm::vec3& minCorner, const glm::vec3& maxCorner);
+
+    // Fit the cascades to the camera frustum (view * proj) for this frame.
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& lightDir);
+
+    // Binds the FBO to one layer and sets the viewport. Depth is cleared unless the
+    // layer already holds the copied static casters.
+    void begin_cascade(int index, bool clear = true) const;
+
+    // Static layer. When stale, render the static casters with static_light_space() after
+    // begin_static_layer(), then call end_static_update(). resample_static_layer() fills the
+    // cascade bound by begin_cascade() before the dynamic casters are drawn; drawQuad draws
+    // a full-screen quad.
+    bool set_static_cache(bool enabled);
+    bool static_cache() const { return staticDepth != 0; }
+    bool static_layer_stale() const { return !staticValid || staticLightSpace != staticFit; }
+    const glm::mat4& static_light_space() const { return staticFit; }
+    void begin_static_layer() const;
+    void end_static_update();
+    void invalidate_static_layer() { staticValid = false; }
+    void resample_static_layer(int index, const std::function<void()>& drawQuad) const;
+
+    const ShadowCascades& get_cascades() const { return cascades; }
+    GLuint texture() const { return depthArray; }
+    int layer_resolution() const { return resolution; }
+    size_t byte_size() const;
+};
@@ -0,0 +1,60 @@
+#include "core/render/temporal_upsample.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+namespace {
+float halton(int index, int base) {
+    float result = 0.0f;
+    float f = 1.0f;
+    for (int i = index; i > 0; i /= base) {
+        f /= static_cast<float>(base);
+        result += f * static_cast<float>(i % base);
+    }
+    return result;
+}
+}
+
+bool TemporalUpsampler::init() {
+    if (!program.load_from_files("core/render/shaders/blur.vert", "core/render/shaders/temporal.frag"))
+        return false;
+    program.bind();
+    glUniform1i(program.uniform_location("colorTexture"), 0);
+    glUniform1i(program.uniform_location("velocityTexture"), 1);
+    glUniform1i(program.uniform_location("historyTexture"), 2);
+    program.unbind();
+    return true;
+}
+
+RenderTargetDesc TemporalUpsampler::history_desc() {
+    RenderTargetDesc desc;
+    desc.color = { {GL_RGBA16F, GL_LINEAR} };
+    return desc;
+}
+
+glm::vec2 TemporalUpsampler::jitter_px() const {
+    // index 0 of the sequence is (0, 0); start at 1 so every phase is distinct
+    return glm::vec2(halton(frame + 1, 2), halton(frame + 1, 3)) - 0.5f;
+}
+
+void TemporalUpsampler::resolve(GLuint color, GLuint velocity, GLuint history, const glm::vec2& jitterPx,
+                                bool historyValid, const std::function<void()>& drawQuad) const {
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+    program.bind();
+    glUniform2fv(program.uniform_location("uJitterPx"), 1, glm::value_ptr(jitterPx));
+    glUniform1i(program.uniform_location("uHistoryValid"), historyValid ? 1 : 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, color);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, velocity);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, history);
+    drawQuad();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    program.unbind();
+    if (blend)
+        glEnable(GL_BLEND);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "core/render/render_target.h"
+#include "core/render/shader_program.h"
+
+// Temporal upsampling: the scene is rendered at a reduced internal resolution with a
+// different sub-pixel projection jitter every frame. The resolve reprojects last frame's
+// full-resolution output through the velocity buffer, clamps it to the current
+// neighbourhood and blends in the new sample. The result is anti-aliased and upscaled.
+// The history targets belong to the caller (see history_desc()).
+class TemporalUpsampler {
+private:
+    static constexpr int JITTER_PHASES = 8;
+
+    ShaderProgram program;
+    int frame = 0;
+
+public:
+    TemporalUpsampler() = default;
+
+    TemporalUpsampler(const TemporalUpsampler&) = delete;
+    TemporalUpsampler& operator=(const TemporalUpsampler&) = delete;
+
+    bool init();
+
+    // RGBA16F at output resolution
+    static RenderTargetDesc history_desc();
+
+    // Advances the jitter sequence; call once per rendered frame.
+    void next_frame() { frame = (frame + 1) % JITTER_PHASES; }
+    int history_index() const { return frame % 2; }   // which history target receives this frame
+    // Halton(2,3) offset of the current frame in internal pixels, within [-0.5, 0.5)
+    glm::vec2 jitter_px() const;
+
+    // Draws drawQuad into the currently bound output-resolution target.
+    // history is the previous output; historyValid = false discards it (first frame, resize).
+    // jitterPx is the jitter the colour input was rendered with.
+    void resolve(GLuint color, GLuint velocity, GLuint history, const glm::vec2& jitterPx,
+                 bool historyValid, const std::function<void()>& drawQuad) const;
+};
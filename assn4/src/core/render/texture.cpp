@@ -1,114 +1,123 @@
 #include "core/render/texture.h"
 
-#include <cstdio>
-#include <vector>
-#include <iostream>
-
-#include <png.h>
+#include <algorithm>
 
 namespace {
-struct PngDeleter {
-    png_structp pngPtr = nullptr;
-    png_infop infoPtr = nullptr;
-    PngDeleter(png_structp p, png_infop i) : pngPtr(p), infoPtr(i) {}
-    ~PngDeleter() {
-        if (pngPtr || infoPtr)
-            png_destroy_read_struct(pngPtr ? &pngPtr : nullptr,
-                                    infoPtr ? &infoPtr : nullptr,
-                                    nullptr);
-    }
-};
+int full_mip_count(int width, int height) {
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2)
+        ++levels;
+    return levels;
 }
 
-Texture2D load_texture_png(const std::string& path, bool generateMips, bool flipY) {
-    FILE* fp = std::fopen(path.c_str(), "rb");
-    if (!fp) {
-        std::cerr << "[Texture] Failed to open " << path << '\n';
-        return {};
+GLenum internal_format(CookedFormat format) {
+    switch (format) {
+    case CookedFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case CookedFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case CookedFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+    case CookedFormat::RGBA8:
+    default: return GL_RGBA8;
     }
+}
 
-    png_byte header[8];
-    if (std::fread(header, 1, 8, fp) != 8 || png_sig_cmp(header, 0, 8)) {
-        std::cerr << "[Texture] " << path << " is not a PNG\n";
-        std::fclose(fp);
-        return {};
-    }
+// A single RGBA8 level means the chain is generated on the GPU.
+bool generates_mips(const CookedTexture& data) {
+    return data.format == CookedFormat::RGBA8 && data.mips.size() == 1;
+}
+}
 
-    png_structp pngPtr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-    if (!pngPtr) {
-        std::fclose(fp);
-        return {};
+bool cooked_format_supported(CookedFormat format) {
+    switch (format) {
+    case CookedFormat::RGBA8: return true;
+    case CookedFormat::BC1:
+    case CookedFormat::BC3: return GLEW_EXT_texture_compression_s3tc;
+    case CookedFormat::BC5: return GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc;
+    default: return false;
     }
+}
 
-    png_infop infoPtr = png_create_info_struct(pngPtr);
-    if (!infoPtr) {
-        png_destroy_read_struct(&pngPtr, nullptr, nullptr);
-        std::fclose(fp);
-        return {};
-    }
+bool decode_texture(const std::string& path, CookedTexture& out) {
+    if (read_cooked_texture(cooked_texture_path(path), out) && cooked_format_supported(out.format))
+        return true;
+
+    Image image;
+    if (!decode_png(path, image))
+        return false;
+
+    CookedMip level;
+    level.width = image.width;
+    level.height = image.height;
+    level.data = std::move(image.pixels);
+    out.format = CookedFormat::RGBA8;
+    out.mips.clear();
+    out.mips.push_back(std::move(level));
+    return true;
+}
 
-    if (setjmp(png_jmpbuf(pngPtr))) {
-        std::cerr << "[Texture] libpng error while reading " << path << '\n';
-        std::fclose(fp);
-        png_destroy_read_struct(&pngPtr, &infoPtr, nullptr);
-        return {};
-    }
+Texture2D allocate_texture(const CookedTexture& data) {
+    const CookedMip& base = data.mips.front();
+    int levels = generates_mips(data) ? full_mip_count(base.width, base.height)
+                                      : static_cast<int>(data.mips.size());
 
-    PngDeleter guard(pngPtr, infoPtr);
-    png_init_io(pngPtr, fp);
-    png_set_sig_bytes(pngPtr, 8);
-    png_read_info(pngPtr, infoPtr);
-
-    png_uint_32 width, height;
-    int bitDepth, colorType;
-    png_get_IHDR(pngPtr, infoPtr, &width, &height, &bitDepth, &colorType, nullptr, nullptr, nullptr);
-
-    // Expand palette/gray to RGB, ensure 8-bit channels, add alpha if missing.
-    if (colorType == PNG_COLOR_TYPE_PALETTE)
-        png_set_palette_to_rgb(pngPtr);
-    if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
-        png_set_expand_gray_1_2_4_to_8(pngPtr);
-    if (png_get_valid(pngPtr, infoPtr, PNG_INFO_tRNS))
-        png_set_tRNS_to_alpha(pngPtr);
-    if (bitDepth == 16)
-        png_set_strip_16(pngPtr);
-    if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
-        png_set_gray_to_rgb(pngPtr);
-    if (colorType == PNG_COLOR_TYPE_RGB)
-        png_set_filler(pngPtr, 0xFF, PNG_FILLER_AFTER);
-
-    png_read_update_info(pngPtr, infoPtr);
-    png_size_t rowBytes = png_get_rowbytes(pngPtr, infoPtr);
-
-    std::vector<png_byte> data(rowBytes * height);
-    std::vector<png_bytep> rows(height);
-    for (size_t y = 0; y < height; ++y) {
-        size_t rowIndex = flipY ? (height - 1 - y) : y;
-        rows[y] = data.data() + rowIndex * rowBytes;
+    Texture2D out;
+    out.width = base.width;
+    out.height = base.height;
+    glGenTextures(1, &out.id);
+    glBindTexture(GL_TEXTURE_2D, out.id);
+
+    GLenum format = internal_format(data.format);
+    if (GLEW_ARB_texture_storage) {
+        glTexStorage2D(GL_TEXTURE_2D, levels, format, base.width, base.height);
+    } else {
+        // Mutable fallback: allocate every level up front so the texture is complete.
+        for (int level = 0, w = base.width, h = base.height; level < levels; ++level) {
+            if (data.format == CookedFormat::RGBA8)
+                glTexImage2D(GL_TEXTURE_2D, level, format, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            else
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, format, w, h, 0,
+                                       static_cast<GLsizei>(cooked_level_size(data.format, w, h)), nullptr);
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+        }
     }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
 
-    png_read_image(pngPtr, rows.data());
-    std::fclose(fp);
+    for (int level = 0, w = base.width, h = base.height; level < levels; ++level) {
+        out.bytes += cooked_level_size(data.format, w, h);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+    return out;
+}
 
-    GLuint tex = 0;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(width), static_cast<GLsizei>(height),
-                 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+void upload_texture_level(CookedFormat format, int level, const CookedMip& mip, const void* pixels) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (format == CookedFormat::RGBA8)
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height,
+                        GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    else
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, internal_format(format),
+                                  static_cast<GLsizei>(mip.data.size()), pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
 
+void finish_texture_upload(const CookedTexture& data) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, generateMips ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    if (generateMips)
+    if (generates_mips(data))
         glGenerateMipmap(GL_TEXTURE_2D);
-
     glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    Texture2D out;
-    out.id = tex;
-    out.width = static_cast<int>(width);
-    out.height = static_cast<int>(height);
-    return out;
+Texture2D create_texture(const CookedTexture& data) {
+    if (data.mips.empty())
+        return {};
+
+    Texture2D tex = allocate_texture(data);
+    for (size_t level = 0; level < data.mips.size(); ++level)
+        upload_texture_level(data.format, static_cast<int>(level), data.mips[level], data.mips[level].data.data());
+    finish_texture_upload(data);
+    return tex;
 }
@@ -1,16 +1,35 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <GL/glew.h>
 
+#include "core/render/cooked_texture.h"
+#include "core/render/image.h"
+
 struct Texture2D {
     GLuint id = 0;
     int width = 0;
     int height = 0;
+    size_t bytes = 0;   // GPU memory including the mip chain
 };
 
-// Load an 8-bit per channel PNG into an OpenGL 2D texture.
-// Returns {0,0,0} on failure.
-Texture2D load_texture_png(const std::string& path,
-                           bool generateMips = true,
-                           bool flipY = true);
+// Whether the current context can sample the cooked format directly.
+bool cooked_format_supported(CookedFormat format);
+
+// CPU-side decode, safe to run off the GL thread. Prefers the cooked container next
+// to the asset (see cooked_texture_path) when its format is supported; otherwise the
+// PNG becomes a single RGBA8 level whose mips are generated on upload.
+bool decode_texture(const std::string& path, CookedTexture& out);
+
+// Immutable storage (glTexStorage2D when available) sized for the full mip chain.
+// Leaves the texture bound to GL_TEXTURE_2D.
+Texture2D allocate_texture(const CookedTexture& data);
+
+// Upload one level from client memory, or from the bound GL_PIXEL_UNPACK_BUFFER
+// when pixels is a buffer offset. Finish with finish_texture_upload().
+void upload_texture_level(CookedFormat format, int level, const CookedMip& mip, const void* pixels);
+void finish_texture_upload(const CookedTexture& data);
+
+// allocate + upload + finish straight from client memory (synchronous path).
+Texture2D create_texture(const CookedTexture& data);
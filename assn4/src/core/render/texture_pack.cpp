@@ -0,0 +1,175 @@
+#include "core/render/texture_pack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <utility>
+
+#include "core/render/texture.h"
+
+namespace {
+constexpr int ATLAS_PADDING = 2;      // extruded border per side, enough for one mip level
+constexpr int ATLAS_MIN_SIZE = 256;
+constexpr int ATLAS_MAX_SIZE = 4096;
+
+struct Placement {
+    int index;
+    int x = 0;
+    int y = 0;
+};
+
+// Shelf packing: tallest first, left to right, new shelf when the row is full.
+bool shelf_pack(const std::vector<Image>& images, std::vector<Placement>& items, int size) {
+    int x = 0, y = 0, shelfHeight = 0;
+    for (auto& item : items) {
+        int w = images[item.index].width + ATLAS_PADDING * 2;
+        int h = images[item.index].height + ATLAS_PADDING * 2;
+        if (x + w > size) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (w > size || y + h > size)
+            return false;
+        item.x = x + ATLAS_PADDING;
+        item.y = y + ATLAS_PADDING;
+        x += w;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+    return true;
+}
+
+// Copy the image and repeat its edge texels into the padding to avoid filtering bleed.
+void blit_extruded(std::vector<unsigned char>& atlas, int atlasSize, const Image& image, int dstX, int dstY) {
+    for (int y = -ATLAS_PADDING; y < image.height + ATLAS_PADDING; ++y) {
+        int srcY = std::clamp(y, 0, image.height - 1);
+        for (int x = -ATLAS_PADDING; x < image.width + ATLAS_PADDING; ++x) {
+            int srcX = std::clamp(x, 0, image.width - 1);
+            const unsigned char* src = &image.pixels[(static_cast<size_t>(srcY) * image.width + srcX) * 4];
+            unsigned char* dst = &atlas[(static_cast<size_t>(dstY + y) * atlasSize + dstX + x) * 4];
+            std::memcpy(dst, src, 4);
+        }
+    }
+}
+}
+
+int TexturePacker::add(const std::string& path) {
+    int index = find(path);
+    if (index >= 0)
+        return index;
+    paths.push_back(path);
+    return static_cast<int>(paths.size() - 1);
+}
+
+int TexturePacker::find(const std::string& path) const {
+    auto it = std::find(paths.begin(), paths.end(), path);
+    return it != paths.end() ? static_cast<int>(it - paths.begin()) : -1;
+}
+
+const PackedTexture& TexturePacker::result(int index) const {
+    static const PackedTexture unpacked;
+    if (index < 0 || static_cast<size_t>(index) >= results.size())
+        return unpacked;
+    return results[index];
+}
+
+void TexturePacker::build() {
+    release();
+    results.assign(paths.size(), {});
+
+    std::vector<Image> images(paths.size());
+    std::map<std::pair<int, int>, std::vector<int>> bySize;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!decode_png(paths[i], images[i]))
+            continue;
+        if (images[i].width > maxSize || images[i].height > maxSize)
+            continue;
+        bySize[{images[i].width, images[i].height}].push_back(static_cast<int>(i));
+    }
+
+    // The most common size (at least two images) becomes the texture array.
+    const std::vector<int>* arrayGroup = nullptr;
+    for (const auto& kv : bySize)
+        if (kv.second.size() >= 2 && (!arrayGroup || kv.second.size() > arrayGroup->size()))
+            arrayGroup = &kv.second;
+
+    if (arrayGroup) {
+        const Image& first = images[arrayGroup->front()];
+        GLsizei layers = static_cast<GLsizei>(arrayGroup->size());
+
+        glGenTextures(1, &arrayTexture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, arrayTexture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, first.width, first.height, layers,
+                     0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        for (GLsizei layer = 0; layer < layers; ++layer) {
+            int index = (*arrayGroup)[layer];
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, first.width, first.height, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, images[index].pixels.data());
+            results[index].texture = arrayTexture;
+            results[index].layer = layer;
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    // Everything else that is small enough goes into the atlas.
+    std::vector<Placement> items;
+    for (const auto& kv : bySize)
+        if (&kv.second != arrayGroup)
+            for (int index : kv.second)
+                items.push_back({index});
+    if (items.empty())
+        return;
+
+    std::sort(items.begin(), items.end(), [&](const Placement& a, const Placement& b) {
+        return images[a.index].height > images[b.index].height;
+    });
+
+    int atlasSize = ATLAS_MIN_SIZE;
+    while (atlasSize <= ATLAS_MAX_SIZE && !shelf_pack(images, items, atlasSize))
+        atlasSize *= 2;
+    if (atlasSize > ATLAS_MAX_SIZE) {
+        std::cerr << "[Texture] Atlas overflow, leaving " << items.size() << " textures unpacked\n";
+        return;
+    }
+
+    std::vector<unsigned char> atlas(static_cast<size_t>(atlasSize) * atlasSize * 4, 0);
+    for (const auto& item : items) {
+        const Image& image = images[item.index];
+        blit_extruded(atlas, atlasSize, image, item.x, item.y);
+
+        float inv = 1.0f / static_cast<float>(atlasSize);
+        results[item.index].rect = glm::vec4(item.x * inv, item.y * inv, image.width * inv, image.height * inv);
+    }
+
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1); // padding only covers the first mip
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    for (const auto& item : items)
+        results[item.index].texture = atlasTexture;
+}
+
+void TexturePacker::release() {
+    if (arrayTexture) {
+        glDeleteTextures(1, &arrayTexture);
+        arrayTexture = 0;
+    }
+    if (atlasTexture) {
+        glDeleteTextures(1, &atlasTexture);
+        atlasTexture = 0;
+    }
+    results.assign(paths.size(), {});
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Where a source image ended up after packing.
+struct PackedTexture {
+    GLuint texture = 0;                         // GL_TEXTURE_2D_ARRAY or atlas GL_TEXTURE_2D
+    int layer = -1;                             // >= 0 when stored in the texture array
+    glm::vec4 rect = glm::vec4(0, 0, 1, 1);     // atlas sub-rect: offset.xy, scale.zw
+    bool packed() const { return texture != 0; }
+};
+
+// Load-time packer for small textures. Images that share the most common size
+// go into one GL_TEXTURE_2D_ARRAY; the remaining ones are shelf-packed into an
+// atlas with a UV remap. Images larger than maxSize are left alone.
+class TexturePacker {
+private:
+    std::vector<std::string> paths;
+    std::vector<PackedTexture> results;
+    GLuint arrayTexture = 0;
+    GLuint atlasTexture = 0;
+    int maxSize;
+
+public:
+    explicit TexturePacker(int _maxSize = 256) : maxSize(_maxSize) {}
+    ~TexturePacker() = default;   // GL objects go in release(), while the context is alive
+
+    TexturePacker(const TexturePacker&) = delete;
+    TexturePacker& operator=(const TexturePacker&) = delete;
+
+    // Returns the index used to query the result after build().
+    int add(const std::string& path);
+    int find(const std::string& path) const;   // -1 if never added
+    void build();
+    void release();
+
+    // Unpacked (texture == 0) until build() has placed the image.
+    const PackedTexture& result(int index) const;
+    GLuint array_texture() const { return arrayTexture; }
+    GLuint atlas_texture() const { return atlasTexture; }
+};
@@ -0,0 +1,188 @@
+#include "core/render/texture_streamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+const void* buffer_offset(size_t offset) {
+    return reinterpret_cast<const void*>(static_cast<uintptr_t>(offset));
+}
+}
+
+TextureStreamer::~TextureStreamer() {
+    stop_worker(); // GL objects are left to shutdown(); the context may already be gone here
+}
+
+void TextureStreamer::request(uint32_t id, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!worker.joinable())
+        worker = std::thread(&TextureStreamer::run, this);
+    jobs.push_back({id, path});
+    wake.notify_one();
+}
+
+void TextureStreamer::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || !jobs.empty(); });
+        if (stopping)
+            return;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        inFlight = job.id;
+        lock.unlock();
+
+        Decoded item{job.id, false, {}};
+        item.ok = decode_texture(job.path, item.data);
+
+        lock.lock();
+        decoded.push_back(std::move(item));
+        inFlight = INVALID_JOB;
+        decodedCv.notify_all();
+    }
+}
+
+void TextureStreamer::stop_worker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        wake.notify_one();
+    }
+    if (worker.joinable())
+        worker.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.clear();
+    decoded.clear();
+    stopping = false;
+}
+
+bool TextureStreamer::staging_ready(Staging& staging) {
+    if (!staging.fence)
+        return true;
+    GLenum status = glClientWaitSync(staging.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false; // GPU still reading this buffer; try again next frame
+    glDeleteSync(staging.fence);
+    staging.fence = nullptr;
+    return true;
+}
+
+StreamedTexture TextureStreamer::upload(const Decoded& item, Staging& staging) {
+    auto start = Clock::now();
+    size_t size = item.data.byte_size();
+
+    if (!staging.pbo)
+        glGenBuffers(1, &staging.pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.pbo);
+    if (staging.capacity < size) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+        staging.capacity = size;
+    }
+
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!dst) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return {item.id, create_texture(item.data), elapsed_ms(start)};
+    }
+
+    size_t offset = 0;
+    for (const auto& mip : item.data.mips) {
+        std::memcpy(static_cast<unsigned char*>(dst) + offset, mip.data.data(), mip.data.size());
+        offset += mip.data.size();
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // Sources are offsets into the bound unpack buffer, so these calls return without copying.
+    Texture2D tex = allocate_texture(item.data);
+    offset = 0;
+    for (size_t level = 0; level < item.data.mips.size(); ++level) {
+        const CookedMip& mip = item.data.mips[level];
+        upload_texture_level(item.data.format, static_cast<int>(level), mip, buffer_offset(offset));
+        offset += mip.data.size();
+    }
+    finish_texture_upload(item.data);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    staging.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    return {item.id, tex, elapsed_ms(start)};
+}
+
+void TextureStreamer::pump(size_t byteBudget, std::vector<StreamedTexture>& ready) {
+    size_t spent = 0;
+    while (spent < byteBudget) {
+        Decoded item{INVALID_JOB, false, {}};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (decoded.empty())
+                return;
+            item = std::move(decoded.front());
+            decoded.pop_front();
+        }
+
+        if (!item.ok) {
+            ready.push_back({item.id, {}, 0.0});
+            continue;
+        }
+
+        Staging& staging = ring[nextStaging];
+        if (!staging_ready(staging)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_front(std::move(item));
+            return;
+        }
+        nextStaging = (nextStaging + 1) % RING_SIZE;
+
+        ready.push_back(upload(item, staging));
+        spent += item.data.byte_size();
+    }
+}
+
+StreamedTexture TextureStreamer::finish(uint32_t id) {
+    auto start = Clock::now();
+    auto matches = [id](const auto& entry) { return entry.id == id; };
+    Decoded item{id, false, {}};
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (auto it = std::find_if(jobs.begin(), jobs.end(), matches); it != jobs.end()) {
+        // Not started yet: decode here instead of waiting behind other jobs.
+        std::string path = std::move(it->path);
+        jobs.erase(it);
+        lock.unlock();
+        item.ok = decode_texture(path, item.data);
+    } else {
+        decodedCv.wait(lock, [&] {
+            return inFlight != id || std::any_of(decoded.begin(), decoded.end(), matches);
+        });
+        auto done = std::find_if(decoded.begin(), decoded.end(), matches);
+        if (done == decoded.end())
+            return {id, {}, elapsed_ms(start)};
+        item = std::move(*done);
+        decoded.erase(done);
+        lock.unlock();
+    }
+
+    Texture2D tex = item.ok ? create_texture(item.data) : Texture2D{};
+    return {id, tex, elapsed_ms(start)};
+}
+
+void TextureStreamer::shutdown() {
+    stop_worker();
+    for (auto& staging : ring) {
+        if (staging.fence)
+            glDeleteSync(staging.fence);
+        if (staging.pbo)
+            glDeleteBuffers(1, &staging.pbo);
+        staging = {};
+    }
+    nextStaging = 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "core/render/cooked_texture.h"
+#include "core/render/texture.h"
+
+struct StreamedTexture {
+    uint32_t id = 0;        // caller-chosen request id
+    Texture2D texture;      // id == 0 when decoding failed
+    double uploadMs = 0.0;  // render-thread time spent on this texture
+};
+
+// Asynchronous texture loading: a worker thread decodes files into CPU memory,
+// pump() copies finished ones into a small ring of pixel-unpack buffers and
+// issues the uploads into immutable storage, so the copy to VRAM overlaps with
+// rendering. A ring slot is reused only once its fence has signalled.
+class TextureStreamer {
+private:
+    static constexpr int RING_SIZE = 3;
+    static constexpr uint32_t INVALID_JOB = 0xFFFFFFFFu;
+
+    struct Job {
+        uint32_t id;
+        std::string path;
+    };
+
+    struct Decoded {
+        uint32_t id;
+        bool ok;
+        CookedTexture data;
+    };
+
+    struct Staging {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        size_t capacity = 0;
+    };
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;       // worker: new job or stop
+    std::condition_variable decodedCv;  // render thread: finish() waiting on a decode
+    std::deque<Job> jobs;
+    std::deque<Decoded> decoded;
+    uint32_t inFlight = INVALID_JOB;    // id the worker is decoding right now
+    bool stopping = false;
+
+    std::array<Staging, RING_SIZE> ring;
+    size_t nextStaging = 0;
+
+    void run();
+    void stop_worker();
+    bool staging_ready(Staging& staging);
+    StreamedTexture upload(const Decoded& item, Staging& staging);
+
+public:
+    TextureStreamer() = default;
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Queue a decode; the worker thread is started on first use.
+    void request(uint32_t id, const std::string& path);
+
+    // Upload decoded textures until byteBudget is spent (at least one per call).
+    void pump(size_t byteBudget, std::vector<StreamedTexture>& ready);
+
+    // Stall path: wait for this request's decode, then upload it immediately.
+    StreamedTexture finish(uint32_t id);
+
+    // Join the worker and free the staging buffers (needs a current GL context).
+    void shutdown();
+};
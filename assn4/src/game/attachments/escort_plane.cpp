@@ -36,43 +36,31 @@ EscortPlane::EscortPlane(
         set_parent(_parent);
     }
     set_mesh(load_mesh("assets/models/starship.obj"));
+    material = gMaterials.create("starship", {"assets/textures/diffuse_starship.png", "assets/textures/normal_quilt.png"});
 }
 
-void EscortPlane::draw_shape() const {
-    const auto mesh = get_mesh();
-    if (!mesh)
-        return;
-
-    glm::mat4 model = get_finalMatrix();
-    glm::mat4 prevModel = get_prevModelMatrix();
-
-    model = glm::scale(model, glm::vec3(10.0f));
+glm::mat4 EscortPlane::apply_shape_fixup(const glm::mat4& world) const {
+    glm::mat4 model = glm::scale(world, glm::vec3(10.0f));
     model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0, 0, 1));
     model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1, 0, 0));
-    prevModel = glm::scale(prevModel, glm::vec3(10.0f));
-    prevModel = glm::rotate(prevModel, glm::radians(-90.0f), glm::vec3(0, 0, 1));
-    prevModel = glm::rotate(prevModel, glm::radians(90.0f), glm::vec3(1, 0, 0));
-    if (isLeftPlane) {
+    if (isLeftPlane)
         model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 1, 0));
-        prevModel = glm::rotate(prevModel, glm::radians(180.0f), glm::vec3(0, 1, 0));
-    }
+    return model;
+}
 
-    if (diffuseTex == 0)
-        diffuseTex = gRenderer.get_or_load_texture("assets/textures/diffuse_starship.png");
-    if (normalTex == 0) {
-        normalTex = gRenderer.get_or_load_texture("assets/textures/normal_quilt.png");
-        hasNormalMap = (normalTex != 0);
-    }
+void EscortPlane::draw_shape() const {
+    const auto mesh = get_mesh();
+    if (!mesh)
+        return;
 
-    gRenderer.draw_mesh(*mesh, model, prevModel, glm::vec4(1.0f), true, diffuseTex, normalTex, hasNormalMap);
+    gRenderer.submit(*mesh, shape_matrix(), prev_shape_matrix(), material);
 }
 
 void EscortPlane::update_logic(float deltaTime) {
     animationTime += deltaTime;
 
     if (isDetached) {
-        detachedWorldMatrix = glm::translate(detachedWorldMatrix, travelDirection * travelSpeed * deltaTime);
-        set_modelMatrix(detachedWorldMatrix);
+        translate_local(travelDirection * travelSpeed * deltaTime);
 
         if (is_outside_window(get_pos())) {
             set_isActive(false);
@@ -101,9 +89,9 @@ void EscortPlane::detach_to_world() {
     if (isDetached)
         return;
 
-    detachedWorldMatrix = get_finalMatrix();
+    glm::mat4 world = get_finalMatrix();
     set_parent(nullptr);
-    set_modelMatrix(detachedWorldMatrix);
+    set_modelMatrix(world);
     set_parent(&sceneRoot, true);
 
     isDetached = true;
@@ -131,5 +119,4 @@ void EscortPlane::reset() {
     currentScale = 1.0f;
     isDetached = false;
     travelDirection = glm::vec3(0.0f);
-    detachedWorldMatrix = glm::mat4(1.0f);
 }
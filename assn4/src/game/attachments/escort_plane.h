@@ -2,6 +2,7 @@
 
 #include <GL/glew.h>
 #include "core/base/object.h"
+#include "core/render/material.h"
 
 class EscortPlane : public Object {
 private:
@@ -12,14 +13,11 @@ private:
     float phaseOffset;
     float pulseAmplitude;
     bool isLeftPlane;
-    mutable GLuint diffuseTex = 0;
-    mutable GLuint normalTex = 0;
-    mutable bool hasNormalMap = false;
+    MaterialId material = INVALID_MATERIAL;
 
     const float travelSpeed = 50.0f;
     bool isDetached = false;
     glm::vec3 travelDirection = glm::vec3(0.0f);
-    glm::mat4 detachedWorldMatrix = glm::mat4(1.0f);
     Object* initialParent = nullptr;
     glm::vec3 initialPos;
     GLfloat initialAngle;
@@ -42,6 +40,7 @@ public:
         bool _isLeftPlane = false
     );
 
+    glm::mat4 apply_shape_fixup(const glm::mat4& world) const override;
     void draw_shape() const override;
     void update_logic(float deltaTime) override;
     void apply_parent_rotation_correction(float deltaDegrees);
@@ -30,6 +30,8 @@ Lower::Lower(
     initialCenter(_center) {
     if (_parent) set_parent(_parent);
     set_mesh(load_mesh("assets/models/lower_arm.obj"));
+    // Match starship diffuse palette average (approx. 0.15, 0.42, 0.43)
+    material = gMaterials.create("arm", {"", "", glm::vec4(0.15f, 0.42f, 0.43f, 1.0f)});
 }
 
 void Lower::draw_shape() const {
@@ -37,9 +39,7 @@ void Lower::draw_shape() const {
     if (!mesh)
         return;
 
-    glm::mat4 model = get_finalMatrix();
-    // Match starship diffuse palette average (approx. 0.15, 0.42, 0.43)
-    gRenderer.draw_mesh(*mesh, model, get_prevModelMatrix(), glm::vec4(0.15f, 0.42f, 0.43f, 1.0f));
+    gRenderer.submit(*mesh, get_finalMatrix(), get_prevModelMatrix(), material);
 }
 
 void Lower::update_logic(float deltaTime) {
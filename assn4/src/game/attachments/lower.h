@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/base/object.h"
+#include "core/render/material.h"
 #include "escort_plane.h"
 
 class Lower : public Object {
@@ -12,6 +13,7 @@ private:
     float swingFrequency;
     float phaseOffset;
     float pendingParentRotation = 0.0f;
+    MaterialId material = INVALID_MATERIAL;
 
     glm::vec3 initialPos;
     GLfloat   initialAngle;
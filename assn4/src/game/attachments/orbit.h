@@ -2,15 +2,14 @@
 
 #include <GL/glew.h>
 #include "core/base/object.h"
+#include "core/render/material.h"
 #include "core/render/renderer.h"
 #include <glm/gtc/matrix_transform.hpp>
 
 class Orbit : public Object {
 private:
     float velocity = 90.0f;
-    mutable GLuint diffuseTex = 0;
-    mutable GLuint normalTex = 0;
-    mutable bool hasNormalMap = false;
+    MaterialId material = INVALID_MATERIAL;
 public:
     Orbit(
         glm::vec3 _pos=ZERO, 
@@ -20,6 +19,7 @@ public:
         glm::vec3 _center=ZERO
     ) : Object(_pos, _angle, _axis, _size, _center) {
         set_mesh(load_mesh("assets/models/sphere.obj"));     
+        material = gMaterials.create("orbit", {"assets/textures/diffuse_primary.png", "assets/textures/normal_organic.png"});
     };
 
     void draw_shape() const override {
@@ -27,25 +27,14 @@ public:
         if (!mesh)
             return;
 
-        glm::mat4 model = get_finalMatrix();
-        glm::mat4 prevModel = get_prevModelMatrix();
+        // White tint so the texture shows its original colors
+        gRenderer.submit(*mesh, shape_matrix(), prev_shape_matrix(), material);
+    }
 
-        model = glm::scale(model, glm::vec3(0.8f));
+    glm::mat4 apply_shape_fixup(const glm::mat4& world) const override {
+        glm::mat4 model = glm::scale(world, glm::vec3(0.8f));
         model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-        model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 0, 1));
-        prevModel = glm::scale(prevModel, glm::vec3(0.8f));
-        prevModel = glm::rotate(prevModel, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-        prevModel = glm::rotate(prevModel, glm::radians(180.0f), glm::vec3(0, 0, 1));
-
-        if (diffuseTex == 0)
-            diffuseTex = gRenderer.get_or_load_texture("assets/textures/diffuse_primary.png");
-        if (normalTex == 0) {
-            normalTex = gRenderer.get_or_load_texture("assets/textures/normal_organic.png");
-            hasNormalMap = (normalTex != 0);
-        }
-
-        // Use white tint so texture shows its original colors
-        gRenderer.draw_mesh(*mesh, model, prevModel, glm::vec4(1.0f), true, diffuseTex, normalTex, hasNormalMap);
+        return glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 0, 1));
     }
 
     void update_logic(float deltaTime) override {
@@ -34,6 +34,8 @@ Upper::Upper(
     initialCenter(_center) {
     if (_parent) set_parent(_parent);
     set_mesh(load_mesh("assets/models/upper_arm.obj"));
+    // Match starship diffuse palette average (approx. 0.15, 0.42, 0.43)
+    material = gMaterials.create("arm", {"", "", glm::vec4(0.15f, 0.42f, 0.43f, 1.0f)});
 }
 
 void Upper::draw_shape() const {
@@ -41,10 +43,7 @@ void Upper::draw_shape() const {
     if (!mesh)
         return;
 
-    glm::mat4 model = get_finalMatrix();
-
-    // Match starship diffuse palette average (approx. 0.15, 0.42, 0.43)
-    gRenderer.draw_mesh(*mesh, model, get_prevModelMatrix(), glm::vec4(0.15f, 0.42f, 0.43f, 1.0f));
+    gRenderer.submit(*mesh, get_finalMatrix(), get_prevModelMatrix(), material);
 }
 
 void Upper::update_logic(float deltaTime) {
@@ -2,6 +2,7 @@
 
 #include "core/base/object.h"
 #include "core/base/object_pool.h"
+#include "core/render/material.h"
 #include "lower.h"
 
 
@@ -13,6 +14,7 @@ private:
     float swingAmplitude;
     float swingFrequency;
     float phaseOffset;    
+    MaterialId material = INVALID_MATERIAL;
 
     glm::vec3 initialPos;
     GLfloat   initialAngle;
@@ -79,30 +79,18 @@ void Enemy::update_logic(float deltaTime) {
     }
 }
 
+glm::mat4 Enemy::apply_shape_fixup(const glm::mat4& world) const {
+    glm::mat4 model = glm::scale(world, glm::vec3(5.0f));
+    model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1, 0, 0));
+    return glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 0, 1));
+}
+
 void Enemy::draw_shape() const {
     const auto mesh = get_mesh();
     if (!mesh)
         return;
 
-    if (diffuseTex == 0)
-        diffuseTex = gRenderer.get_or_load_texture("assets/textures/diffuse_starship.png");
-    if (normalTex == 0) {
-        normalTex = gRenderer.get_or_load_texture("assets/textures/normal_quilt.png");
-        hasNormalMap = (normalTex != 0);
-    }
-
-    
-    glm::mat4 model = get_finalMatrix();
-    glm::mat4 prevModel = get_prevModelMatrix();
-    model = glm::scale(model, glm::vec3(5.0f));
-    model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-    model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 0, 1));
-
-    prevModel = glm::scale(prevModel, glm::vec3(5.0f));
-    prevModel = glm::rotate(prevModel, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-    prevModel = glm::rotate(prevModel, glm::radians(180.0f), glm::vec3(0, 0, 1));
-
-    gRenderer.draw_mesh(*mesh, model, prevModel, glm::vec4(1.0f, 1.0f, 1.0f, 0.9f), true, diffuseTex, normalTex, hasNormalMap);
+    gRenderer.submit(*mesh, shape_matrix(), prev_shape_matrix(), material, glm::vec4(1.0f, 1.0f, 1.0f, 0.9f));
 }
 
 void Enemy::shoot(){
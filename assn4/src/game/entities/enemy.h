@@ -6,6 +6,7 @@
 #include <GL/glew.h>
 #include "core/base/object.h"
 #include "core/base/object_pool.h"
+#include "core/render/material.h"
 #include "game/ui/healthbar.h"
 #include "game/weapons/bullet.h"
 #include "game/attachments/upper.h"
@@ -37,10 +38,8 @@ private:
 
     Player* player = nullptr;
 
-    // Textures for the main starship body
-    mutable GLuint diffuseTex = 0;
-    mutable GLuint normalTex = 0;
-    mutable bool hasNormalMap = false;
+    // Shared starship body material
+    MaterialId material = INVALID_MATERIAL;
 
 public:
     Enemy(
@@ -58,6 +57,7 @@ public:
         set_hitboxRadius(outerR);
         init_vertices();        
         set_mesh(load_mesh("assets/models/starship.obj"));
+        material = gMaterials.create("starship", {"assets/textures/diffuse_starship.png", "assets/textures/normal_quilt.png"});
     };  
     
     ObjectPool<Bullet>& get_bulletPool() { return bulletPool; }
@@ -65,6 +65,7 @@ public:
     void set_player(Player* obj) { player = obj; }
 
     void update_logic(float deltaTime) override;
+    glm::mat4 apply_shape_fixup(const glm::mat4& world) const override;
     void draw_shape() const override;
     
     inline void take_damage(int damage) { heart = std::max(0, heart - damage); }
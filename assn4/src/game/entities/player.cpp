@@ -24,14 +24,8 @@ float calculate_matrix_difference(const glm::mat4& model, const glm::mat4& prevM
     return std::sqrt(sum_sq); 
 }
 
-void Player::draw_shape() const {
-    const auto mesh = get_mesh();
-    if (!mesh)
-        return;
-
-    glm::mat4 model = get_finalMatrix();
-    glm::mat4 prevModel = get_prevModelMatrix();
-
+glm::mat4 Player::apply_shape_fixup(const glm::mat4& world) const {
+    glm::mat4 model = world;
     if (direction == UP)
         model = glm::rotate(model, glm::radians(-20.0f), glm::vec3(1, 0, 0));
     else if (direction == DOWN)
@@ -43,22 +37,16 @@ void Player::draw_shape() const {
 
     model = glm::scale(model, glm::vec3(0.3f));
     model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-    model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 0, 1));
+    return glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 0, 1));
+}
 
-    prevModel = glm::scale(prevModel, glm::vec3(0.3f));
-    prevModel = glm::rotate(prevModel, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-    prevModel = glm::rotate(prevModel, glm::radians(180.0f), glm::vec3(0, 0, 1));
+void Player::draw_shape() const {
+    const auto mesh = get_mesh();
+    if (!mesh)
+        return;
 
     glm::vec4 color(1.0f, 1.0f, 1.0f, isRecovery ? 0.2f : 1.0f);
-    if (diffuseTex == 0) {
-        diffuseTex = gRenderer.get_or_load_texture("assets/textures/diffuse_jet.png");
-    }
-    if (normalTex == 0) {
-        normalTex = gRenderer.get_or_load_texture("assets/textures/normal_quilt.png");
-        hasNormalMap = (normalTex != 0);
-    }
-
-    gRenderer.draw_mesh(*mesh, model, prevModel, color, true, diffuseTex, normalTex, hasNormalMap);
+    gRenderer.submit(*mesh, shape_matrix(), prev_shape_matrix(), material, color);
 }
 
 void Player::update_logic(float deltaTime) {
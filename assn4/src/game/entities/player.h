@@ -1,10 +1,12 @@
 #pragma once
 
+#include <array>
 #include <vector>
 
 #include <GL/glew.h>
 
 #include "core/base/object.h"
+#include "core/render/material.h"
 #include "game/weapons/canon.h"
 #include "game/attachments/orbit.h"
 #include "core/base/scene_node.h"
@@ -30,13 +32,11 @@ private:
 
     int heart = MAX_HEART;
 
-    std::vector<Orbit> orbits;
+    std::array<Orbit, MAX_HEART> orbits;   // Objects are not copyable, so they live in place
 
     std::vector<Enemy*> enemies;
 
-    mutable GLuint diffuseTex = 0;
-    mutable GLuint normalTex = 0;
-    mutable bool hasNormalMap = false;
+    MaterialId material = INVALID_MATERIAL;
 
 public:
     Player(
@@ -50,17 +50,17 @@ public:
         rightCanon.init(glm::vec3(0.8, 0.2, 0));
         leftCanon.set_parent(this);
         rightCanon.set_parent(this);
-        orbits.reserve(MAX_HEART);
         set_mesh(load_mesh("assets/models/jet.obj"));
+        material = gMaterials.create("jet", {"assets/textures/diffuse_jet.png", "assets/textures/normal_quilt.png"});
         for (int i = 1; i <= heart; i++) {
-            Orbit & orbit = orbits.emplace_back();
+            Orbit & orbit = orbits[i - 1];
             orbit.init(glm::vec3(4,0,0), 0, UP, glm::vec3(1.5));
             orbit.rotate_world(360.0f/heart * (i-1), FORWARD);
             orbit.set_parent(this);
         }
     };
 
-    std::vector<Canon*> get_canons() { return {&leftCanon, &rightCanon}; }
+    std::array<Canon*, 2> get_canons() { return {&leftCanon, &rightCanon}; }
     glm::vec3 get_direction() { return direction; }
     
     void set_velocity(float v) { velocity = v; }
@@ -71,6 +71,7 @@ public:
     void set_enemies(std::vector<Enemy*>& _enemies) { enemies = _enemies; }
 
     void update_logic(float deltaTime) override;
+    glm::mat4 apply_shape_fixup(const glm::mat4& world) const override;
     void draw_shape() const override;
 
     void reset();
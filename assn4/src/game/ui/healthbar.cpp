@@ -15,6 +15,8 @@ Healthbar::Healthbar(
     initialCenter(_center),
     parent(static_cast<Enemy*>(_parent)) { 
     set_mesh(load_mesh("assets/models/healthbar_box.obj"));
+    material = gMaterials.create("healthbar", {"", "", glm::vec4(1.0f), false});
+    set_shadowCaster(ShadowCaster::None);
     if (_parent) set_parent(_parent);
 }
 
@@ -42,7 +44,7 @@ void Healthbar::draw_shape() const {
     glm::mat4 base = get_finalMatrix();
     glm::mat4 bgModel = glm::translate(base, glm::vec3(center_x, center_y, -bg_depth * 0.5f));
     bgModel = glm::scale(bgModel, glm::vec3(bg_width, bg_height, bg_depth));
-    gRenderer.draw_mesh(*mesh, bgModel, bgModel, glm::vec4(0.3f, 0.3f, 0.3f, 1.0f), false);
+    gRenderer.submit(*mesh, bgModel, bgModel, material, glm::vec4(0.3f, 0.3f, 0.3f, 1.0f));
 
     if (health_ratio <= 0.0f)
         return;
@@ -50,7 +52,7 @@ void Healthbar::draw_shape() const {
     const float fill_width = bar_width * health_ratio;
     glm::mat4 fillModel = glm::translate(base, glm::vec3(start_x + fill_width * 0.5f, center_y, fill_depth * 0.5f));
     fillModel = glm::scale(fillModel, glm::vec3(fill_width, bar_height, fill_depth));
-    gRenderer.draw_mesh(*mesh, fillModel, fillModel, glm::vec4(1.0f, health_ratio, 0.0f, 1.0f), false);
+    gRenderer.submit(*mesh, fillModel, fillModel, material, glm::vec4(1.0f, health_ratio, 0.0f, 1.0f));
 }
 
 void Healthbar::deactivate() {
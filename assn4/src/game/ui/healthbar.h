@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/base/object.h"
+#include "core/render/material.h"
 
 class Enemy; 
 
@@ -12,6 +13,7 @@ private:
     glm::vec3 initialSize;
     glm::vec3 initialCenter;
     Enemy* parent;
+    MaterialId material = INVALID_MATERIAL;
 
 public:
     Healthbar(
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "core/base/object.h"
+#include "core/render/material.h"
 
 class Attack : public Object {
 private:
     int damage = 1;
     glm::vec3 velocity = glm::vec3(0, 80, 0);
+    MaterialId material = INVALID_MATERIAL;
 public:
     Attack(
         glm::vec3 _pos = ZERO, 
@@ -15,8 +17,10 @@ public:
         glm::vec3 _center = ZERO
     ) : Object(_pos, _angle, _axis, _size, _center) {
         set_mesh(load_mesh("assets/models/rice.obj"));     
+        material = gMaterials.create("attack", {});
     };
 
+    glm::mat4 apply_shape_fixup(const glm::mat4& world) const override;
     void draw_shape() const override;
     void update_logic(float deltaTime) override;
 
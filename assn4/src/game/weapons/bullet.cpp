@@ -23,25 +23,20 @@ void Bullet::init_vertices(){
     }
 }
 
+glm::mat4 Bullet::apply_shape_fixup(const glm::mat4& world) const {
+    glm::mat4 model = glm::scale(world, glm::vec3(0.7f));
+    model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1, 0, 0));
+    return glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 0, 1));
+}
+
 void Bullet::draw_shape() const {
     const auto mesh = get_mesh();
     if (!mesh)
         return;
 
-    ensure_sonic_child();
-
-    glm::mat4 model = get_finalMatrix();
-    glm::mat4 prevModel = get_prevModelMatrix();
-
-    model = glm::scale(model, glm::vec3(0.7f));
-    model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-    model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 0, 1));
-    prevModel = glm::scale(prevModel, glm::vec3(0.7f));
-    prevModel = glm::rotate(prevModel, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-    prevModel = glm::rotate(prevModel, glm::radians(180.0f), glm::vec3(0, 0, 1));
-
-    gRenderer.draw_mesh(*mesh, model, prevModel, glm::vec4(1.0f)); // bullet always white
+    gRenderer.submit(*mesh, shape_matrix(), prev_shape_matrix(), material); // bullet always white
 
+    // Visual only: the shadow pass submits just the bullet mesh (see shape_matrix()).
     if (sonicMesh) {
         glm::vec3 forward = glm::length(direction) > 1e-5f ? glm::normalize(direction) : glm::vec3(0, 0, 1);
         glm::vec3 up = glm::vec3(0, 0, 1);
@@ -67,10 +62,7 @@ void Bullet::draw_shape() const {
     prevChildModel = glm::rotate(prevChildModel, glm::radians(90.0f), glm::vec3(0, 0, 1));
     prevChildModel = glm::scale(prevChildModel, glm::vec3(0.7f));
 
-    GLuint sonicTex = counter ? sonicDiffuse2 : sonicDiffuse1;
-    if (sonicTex == 0) // fallback if one texture failed to load
-        sonicTex = counter ? sonicDiffuse1 : sonicDiffuse2;
-    gRenderer.draw_mesh(*sonicMesh, childModel, prevChildModel, glm::vec4(1.0f), true, sonicTex, sonicNormal, sonicHasNormal);
+    gRenderer.submit(*sonicMesh, childModel, prevChildModel, counter ? sonicMaterial2 : sonicMaterial1);
 }
 }
 
@@ -78,16 +70,10 @@ void Bullet::update_logic(float deltaTime) {
     translate(velocity * direction * deltaTime);
 }
 
-// Factory-style initializer called after Bullet creation
-void Bullet::ensure_sonic_child() const {
-    if (!sonicMesh)
-        sonicMesh = load_mesh("assets/models/sonic.obj");
-    if (sonicDiffuse1 == 0)
-        sonicDiffuse1 = gRenderer.get_or_load_texture("assets/textures/diffuse_sonic_1.png");
-    if (sonicDiffuse2 == 0)
-        sonicDiffuse2 = gRenderer.get_or_load_texture("assets/textures/diffuse_sonic_2.png");
-    if (sonicNormal == 0) {
-        sonicNormal = gRenderer.get_or_load_texture("assets/textures/normal_flat.png");
-        sonicHasNormal = (sonicNormal != 0);
-    }
+// Factory-style initializer called during Bullet creation
+void Bullet::init_sonic_child() {
+    material = gMaterials.create("bullet", {});
+    sonicMesh = load_mesh("assets/models/sonic.obj");
+    sonicMaterial1 = gMaterials.create("sonic_1", {"assets/textures/diffuse_sonic_1.png", "assets/textures/normal_flat.png"});
+    sonicMaterial2 = gMaterials.create("sonic_2", {"assets/textures/diffuse_sonic_2.png", "assets/textures/normal_flat.png"});
 }
@@ -3,6 +3,7 @@
 #include <vector>
 #include <GL/glew.h>
 #include "core/base/object.h"
+#include "core/render/material.h"
 
 class Bullet : public Object {
 private:
@@ -19,12 +20,12 @@ private:
     glm::vec3 direction = DOWN;
     float velocity = 20.0f;
 
-    // Visual child (sonic obj)
-    mutable std::shared_ptr<Mesh> sonicMesh;
-    mutable GLuint sonicDiffuse1 = 0;
-    mutable GLuint sonicDiffuse2 = 0;
-    mutable GLuint sonicNormal = 0;
-    mutable bool sonicHasNormal = false;
+    MaterialId material = INVALID_MATERIAL;
+
+    // Visual child (sonic obj), one material per counter phase
+    std::shared_ptr<Mesh> sonicMesh;
+    MaterialId sonicMaterial1 = INVALID_MATERIAL;
+    MaterialId sonicMaterial2 = INVALID_MATERIAL;
 public:
     Bullet(
         glm::vec3 _pos=glm::vec3(), 
@@ -36,13 +37,15 @@ public:
         set_hitboxRadius(r + outline);
         init_vertices();        
         set_mesh(load_mesh("assets/models/sphere.obj"));
+        init_sonic_child();
     };
     
+    glm::mat4 apply_shape_fixup(const glm::mat4& world) const override;
     void draw_shape() const override;
     void update_logic(float deltaTime) override;
 
     void set_direction(glm::vec3 dir) { direction = dir; }
     void set_counter(bool c) { counter = c; }
 
-    void ensure_sonic_child() const;
+    void init_sonic_child();
 };
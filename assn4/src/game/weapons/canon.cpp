@@ -4,16 +4,16 @@
 
 #include "core/render/renderer.h"
 
+glm::mat4 Canon::apply_shape_fixup(const glm::mat4& world) const {
+    return glm::scale(world, glm::vec3(0.3f));
+}
+
 void Canon::draw_shape() const {
     const auto mesh = get_mesh();
     if (!mesh)
         return;
 
-    glm::mat4 model = get_finalMatrix();
-    glm::mat4 prevModel = get_prevModelMatrix();
-    model = glm::scale(model, glm::vec3(0.3f));
-    prevModel = glm::scale(prevModel, glm::vec3(0.3f));
-    gRenderer.draw_mesh(*mesh, model, prevModel, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+    gRenderer.submit(*mesh, shape_matrix(), prev_shape_matrix(), material);
 }
 
 void Canon::update_logic(float deltaTime) {
@@ -29,8 +29,5 @@ void Canon::shoot() {
     if (!a)
         return;
 
-    a->init(get_pos(),
-            glm::degrees(glm::angle(get_quat())),
-            glm::axis(get_quat()),
-            glm::vec3(1));
+    a->init(get_pos(), get_quat());
 }
@@ -2,6 +2,7 @@
 
 #include "core/base/object.h"
 #include "core/base/object_pool.h"
+#include "core/render/material.h"
 #include "attack.h"
 
 
@@ -10,6 +11,7 @@ private:
     ObjectPool<Attack> attackPool;
     float shootInterval = 0.2;
     float shootCooldown = shootInterval;
+    MaterialId material = INVALID_MATERIAL;
 public:
     Canon(
         glm::vec3 _pos = ZERO, 
@@ -19,8 +21,10 @@ public:
         glm::vec3 _center = glm::vec3(0, -0.5, 0)
     ) : Object(_pos, _angle, _axis, _size, _center), attackPool(50) {
         set_mesh(load_mesh("assets/models/square.obj"));     
+        material = gMaterials.create("canon", {"", "", glm::vec4(0.5f, 0.5f, 0.5f, 1.0f)});
     };
 
+    glm::mat4 apply_shape_fixup(const glm::mat4& world) const override;
     void draw_shape() const override;
     void update_logic(float deltaTime) override;
 
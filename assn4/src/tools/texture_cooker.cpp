@@ -0,0 +1,322 @@
+// Offline texture cooker: PNG -> .ktex container with a prebuilt mip chain.
+//
+//   texture_cooker [--rgba8] <in.png> <out.ktex>
+//
+// normal_*.png is encoded as BC5 (XY only), other textures as BC1, or BC3 when
+// any texel is not fully opaque. --rgba8 keeps the mips uncompressed.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/render/cooked_texture.h"
+#include "core/render/image.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool is_normal_map(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    return name.rfind("normal_", 0) == 0;
+}
+
+bool has_alpha(const Image& image) {
+    for (size_t i = 3; i < image.pixels.size(); i += 4)
+        if (image.pixels[i] != 255)
+            return true;
+    return false;
+}
+
+// 2x2 box filter; normal maps are renormalized so the chain stays unit length.
+Image downsample(const Image& src, bool normalMap) {
+    Image dst;
+    dst.width = std::max(1, src.width / 2);
+    dst.height = std::max(1, src.height / 2);
+    dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+
+    for (int y = 0; y < dst.height; ++y) {
+        for (int x = 0; x < dst.width; ++x) {
+            int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+            int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+            const int xs[4] = {x0, x1, x0, x1};
+            const int ys[4] = {y0, y0, y1, y1};
+
+            float sum[4] = {0, 0, 0, 0};
+            for (int i = 0; i < 4; ++i) {
+                const unsigned char* p = &src.pixels[(static_cast<size_t>(ys[i]) * src.width + xs[i]) * 4];
+                for (int c = 0; c < 4; ++c)
+                    sum[c] += p[c];
+            }
+            for (float& v : sum)
+                v *= 0.25f;
+
+            if (normalMap) {
+                float n[3];
+                for (int c = 0; c < 3; ++c)
+                    n[c] = sum[c] / 127.5f - 1.0f;
+                float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                if (len > 1e-5f)
+                    for (int c = 0; c < 3; ++c)
+                        sum[c] = (n[c] / len + 1.0f) * 127.5f;
+            }
+
+            unsigned char* out = &dst.pixels[(static_cast<size_t>(y) * dst.width + x) * 4];
+            for (int c = 0; c < 4; ++c)
+                out[c] = static_cast<unsigned char>(std::clamp(std::lround(sum[c]), 0L, 255L));
+        }
+    }
+    return dst;
+}
+
+// 4x4 texels, edge-clamped for levels smaller than a block.
+void fetch_block(const Image& image, int bx, int by, unsigned char block[16][4]) {
+    for (int y = 0; y < 4; ++y) {
+        int sy = std::min(by * 4 + y, image.height - 1);
+        for (int x = 0; x < 4; ++x) {
+            int sx = std::min(bx * 4 + x, image.width - 1);
+            std::memcpy(block[y * 4 + x], &image.pixels[(static_cast<size_t>(sy) * image.width + sx) * 4], 4);
+        }
+    }
+}
+
+uint16_t to_565(const float c[3]) {
+    auto q = [](float v, int maxV) {
+        return static_cast<uint16_t>(std::clamp(std::lround(v * maxV / 255.0f), 0L, static_cast<long>(maxV)));
+    };
+    return static_cast<uint16_t>((q(c[0], 31) << 11) | (q(c[1], 63) << 5) | q(c[2], 31));
+}
+
+void from_565(uint16_t c, int out[3]) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+void put_u16(unsigned char* dst, uint16_t v) {
+    dst[0] = static_cast<unsigned char>(v & 0xFF);
+    dst[1] = static_cast<unsigned char>(v >> 8);
+}
+
+// BC1 color block: endpoints along the principal axis of the block, always 4-color mode.
+void encode_bc1_color(const unsigned char block[16][4], unsigned char out[8]) {
+    float mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c)
+            mean[c] += block[i][c] / 16.0f;
+
+    float cov[6] = {0, 0, 0, 0, 0, 0}; // rr rg rb gg gb bb
+    for (int i = 0; i < 16; ++i) {
+        float d[3] = {block[i][0] - mean[0], block[i][1] - mean[1], block[i][2] - mean[2]};
+        cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+    }
+
+    float axis[3] = {1, 1, 1};
+    for (int iter = 0; iter < 8; ++iter) {
+        float next[3] = {
+            cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+            cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+            cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2],
+        };
+        float len = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (len < 1e-6f)
+            break;
+        for (int c = 0; c < 3; ++c)
+            axis[c] = next[c] / len;
+    }
+
+    float minP = 1e9f, maxP = -1e9f;
+    for (int i = 0; i < 16; ++i) {
+        float p = 0;
+        for (int c = 0; c < 3; ++c)
+            p += (block[i][c] - mean[c]) * axis[c];
+        minP = std::min(minP, p);
+        maxP = std::max(maxP, p);
+    }
+
+    float e0[3], e1[3];
+    for (int c = 0; c < 3; ++c) {
+        e0[c] = std::clamp(mean[c] + axis[c] * maxP, 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + axis[c] * minP, 0.0f, 255.0f);
+    }
+
+    uint16_t c0 = to_565(e0), c1 = to_565(e1);
+    if (c0 < c1)
+        std::swap(c0, c1);
+    put_u16(out, c0);
+    put_u16(out + 2, c1);
+
+    int palette[4][3];
+    from_565(c0, palette[0]);
+    from_565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDist = 1 << 30;
+            for (int k = 0; k < 4; ++k) {
+                int dist = 0;
+                for (int c = 0; c < 3; ++c) {
+                    int d = block[i][c] - palette[k][c];
+                    dist += d * d;
+                }
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = k;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (i * 2);
+        }
+    }
+    for (int b = 0; b < 4; ++b)
+        out[4 + b] = static_cast<unsigned char>((indices >> (b * 8)) & 0xFF);
+}
+
+// BC4 single-channel block (BC3 alpha, BC5 red/green): min/max endpoints, 8-value mode.
+void encode_bc4(const unsigned char block[16][4], int channel, unsigned char out[8]) {
+    int hi = 0, lo = 255;
+    for (int i = 0; i < 16; ++i) {
+        hi = std::max(hi, static_cast<int>(block[i][channel]));
+        lo = std::min(lo, static_cast<int>(block[i][channel]));
+    }
+    out[0] = static_cast<unsigned char>(hi);
+    out[1] = static_cast<unsigned char>(lo);
+
+    int palette[8] = {hi, lo};
+    for (int k = 2; k < 8; ++k)
+        palette[k] = ((8 - k) * hi + (k - 1) * lo) / 7;
+
+    uint64_t indices = 0;
+    if (hi != lo) {
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDist = 1 << 30;
+            for (int k = 0; k < 8; ++k) {
+                int dist = std::abs(block[i][channel] - palette[k]);
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = k;
+                }
+            }
+            indices |= static_cast<uint64_t>(best) << (i * 3);
+        }
+    }
+    for (int b = 0; b < 6; ++b)
+        out[2 + b] = static_cast<unsigned char>((indices >> (b * 8)) & 0xFF);
+}
+
+CookedMip encode_level(const Image& image, CookedFormat format) {
+    CookedMip mip;
+    mip.width = image.width;
+    mip.height = image.height;
+    if (format == CookedFormat::RGBA8) {
+        mip.data = image.pixels;
+        return mip;
+    }
+
+    mip.data.resize(cooked_level_size(format, image.width, image.height));
+    unsigned char* out = mip.data.data();
+    unsigned char block[16][4];
+    for (int by = 0; by < (image.height + 3) / 4; ++by) {
+        for (int bx = 0; bx < (image.width + 3) / 4; ++bx) {
+            fetch_block(image, bx, by, block);
+            switch (format) {
+            case CookedFormat::BC1:
+                encode_bc1_color(block, out);
+                out += 8;
+                break;
+            case CookedFormat::BC3:
+                encode_bc4(block, 3, out);
+                encode_bc1_color(block, out + 8);
+                out += 16;
+                break;
+            case CookedFormat::BC5:
+                encode_bc4(block, 0, out);
+                encode_bc4(block, 1, out + 8);
+                out += 16;
+                break;
+            case CookedFormat::RGBA8:
+                break;
+            }
+        }
+    }
+    return mip;
+}
+}
+
+int main(int argc, char** argv) {
+    bool forceRGBA8 = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rgba8") == 0)
+            forceRGBA8 = true;
+        else
+            args.emplace_back(argv[i]);
+    }
+    if (args.size() != 2) {
+        std::cerr << "usage: texture_cooker [--rgba8] <in.png> <out.ktex>\n";
+        return 1;
+    }
+    const std::string& input = args[0];
+    const std::string& output = args[1];
+
+    auto start = Clock::now();
+    Image image;
+    if (!decode_png(input, image))
+        return 1;
+    double pngMs = elapsed_ms(start);
+
+    bool normalMap = is_normal_map(input);
+    CookedTexture cooked;
+    if (forceRGBA8)
+        cooked.format = CookedFormat::RGBA8;
+    else if (normalMap)
+        cooked.format = CookedFormat::BC5;
+    else
+        cooked.format = has_alpha(image) ? CookedFormat::BC3 : CookedFormat::BC1;
+
+    // Same estimate the runtime uses for a PNG upload with glGenerateMipmap.
+    size_t rgbaBytes = image.pixels.size() + image.pixels.size() / 3;
+
+    Image level = image;
+    while (true) {
+        cooked.mips.push_back(encode_level(level, cooked.format));
+        if (level.width == 1 && level.height == 1)
+            break;
+        level = downsample(level, normalMap);
+    }
+
+    if (!write_cooked_texture(output, cooked)) {
+        std::cerr << "[Cooker] Failed to write " << output << '\n';
+        return 1;
+    }
+
+    // Time the runtime read path for comparison with PNG decode (both from page cache).
+    start = Clock::now();
+    CookedTexture check;
+    if (!read_cooked_texture(output, check))
+        return 1;
+    double cookedMs = elapsed_ms(start);
+
+    std::cout << "[Cooker] " << std::left << std::setw(28) << input.substr(input.find_last_of('/') + 1)
+              << std::setw(6) << cooked_format_name(cooked.format) << std::right
+              << std::setw(5) << image.width << 'x' << std::setw(4) << std::left << image.height << std::right
+              << std::setw(3) << cooked.mips.size() << " mips  VRAM "
+              << std::setw(8) << rgbaBytes << " -> " << std::setw(8) << cooked.byte_size() << " B"
+              << "  load " << std::fixed << std::setprecision(2) << std::setw(6) << pngMs
+              << " -> " << std::setw(5) << cookedMs << " ms\n";
+    return 0;
+}